@@ -0,0 +1,47 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Bench harness definitions (construction and the JSON report).
+*/
+
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "Bench.hpp"
+#include "Collision.hpp"
+
+Bench::Bench(double minSeconds, std::string filter) : m_minSeconds{minSeconds}, m_filter{std::move(filter)}
+{
+}
+
+void Bench::count(const std::string& name, std::uint64_t value)
+{
+    if (name.find(m_filter) != std::string::npos)
+    {
+        m_counts.emplace_back(name, value);
+    }
+}
+
+/** Names never contain characters that need escaping, so they are written as-is */
+void Bench::writeJson(std::ostream& out) const
+{
+    out << "{\n  \"unit\": \"ns/op\",\n  \"collision_kernel\": \"" << Collision::kernelName() << "\",\n  \"benchmarks\": [";
+    for (std::size_t i = 0; i < m_results.size(); i++)
+    {
+        const BenchResult& result = m_results[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"name\": \"" << result.name << "\", \"mushrooms\": " << result.mushrooms
+            << ", \"segments\": " << result.segments << ", \"ns_per_op\": " << result.nsPerOp
+            << ", \"batch\": " << result.batch << "}";
+    }
+    out << "\n  ],\n  \"counts\": [";
+    for (std::size_t i = 0; i < m_counts.size(); i++)
+    {
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"name\": \"" << m_counts[i].first << "\", \"value\": " << m_counts[i].second << "}";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
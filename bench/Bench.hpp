@@ -0,0 +1,146 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+A minimal micro-benchmark harness for centipede_bench.
+Every benchmark is timed in batches, and the median batch is reported in ns/op as JSON.
+*/
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** The timing of one benchmark on one scene */
+struct BenchResult
+{
+    /** What was measured, e.g. "MushroomManager::checkLaserCollision" */
+    std::string name;
+
+    /** Mushrooms in the scene */
+    std::size_t mushrooms = 0;
+
+    /** Centipede segments in the scene */
+    std::size_t segments = 0;
+
+    /** Median time of one operation (nanoseconds) */
+    double nsPerOp = 0;
+
+    /** Operations in each timed batch */
+    std::uint64_t batch = 0;
+};
+
+/**
+ * Runs benchmarks and collects their results.
+ *
+ * The batch size is doubled until one batch takes at least minSeconds / Samples,
+ * then Samples batches are timed and the median is kept. Taking the median
+ * makes the results repeatable on a noisy machine.
+ */
+class Bench
+{
+  public:
+    /** Number of timed batches per benchmark */
+    static constexpr std::size_t Samples = 5;
+
+    /**
+     * Construct a new Bench
+     * @param minSeconds rough time spent on each benchmark
+     * @param filter only run benchmarks whose name contains this (empty runs all)
+     */
+    Bench(double minSeconds, std::string filter);
+
+    /**
+     * Time an operation.
+     *
+     * @param name what is measured
+     * @param mushrooms size of the scene (for the report)
+     * @param segments size of the scene (for the report)
+     * @param op the operation, returns a value that is kept so the work can't be optimized away
+     */
+    template <typename Op>
+    void run(const std::string& name, std::size_t mushrooms, std::size_t segments, Op&& op);
+
+    /**
+     * Record a count that isn't a time (e.g. allocations), reported next to the timings
+     * @param name what is counted
+     * @param value the count
+     */
+    void count(const std::string& name, std::uint64_t value);
+
+    /** Write every result as a JSON document */
+    void writeJson(std::ostream& out) const;
+
+  private:
+    /** Time `batch` calls to op (seconds) */
+    template <typename Op>
+    double time(std::uint64_t batch, Op& op);
+
+    /** Rough time spent on each benchmark (seconds) */
+    double m_minSeconds;
+
+    /** Only run benchmarks with this in their name */
+    std::string m_filter;
+
+    /** Results in the order they ran */
+    std::vector<BenchResult> m_results;
+
+    /** Counts in the order they were recorded */
+    std::vector<std::pair<std::string, std::uint64_t>> m_counts;
+
+    /** Every op result is added here, so the compiler must compute it */
+    volatile std::size_t m_sink = 0;
+};
+
+template <typename Op>
+void Bench::run(const std::string& name, std::size_t mushrooms, std::size_t segments, Op&& op)
+{
+    if (name.find(m_filter) == std::string::npos)
+    {
+        return;
+    }
+
+    // grow the batch until it is long enough to time accurately (this also warms up the caches)
+    const double  target = m_minSeconds / static_cast<double>(Bench::Samples);
+    std::uint64_t batch  = 1;
+    while (this->time(batch, op) < target)
+    {
+        batch *= 2;
+    }
+
+    std::array<double, Bench::Samples> samples{};
+    for (auto& sample : samples)
+    {
+        sample = this->time(batch, op) / static_cast<double>(batch);
+    }
+    std::nth_element(samples.begin(), samples.begin() + Bench::Samples / 2, samples.end());
+
+    BenchResult result;
+    result.name      = name;
+    result.mushrooms = mushrooms;
+    result.segments  = segments;
+    result.nsPerOp   = samples[Bench::Samples / 2] * 1e9;
+    result.batch     = batch;
+    m_results.push_back(result);
+}
+
+template <typename Op>
+double Bench::time(std::uint64_t batch, Op& op)
+{
+    std::size_t sink  = 0;
+    const auto  start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < batch; i++)
+    {
+        sink += static_cast<std::size_t>(op());
+    }
+    const auto end = std::chrono::steady_clock::now();
+    m_sink         = m_sink + sink;
+    return std::chrono::duration<double>(end - start).count();
+}
@@ -0,0 +1,448 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Micro-benchmarks of the collision, movement and draw hot paths.
+Each benchmark runs over synthetic scenes of growing size, so the cost of the
+O(n^2) collision paths can be tracked as the scene grows.
+The global allocator is counted, to check that a steady game tick never calls it.
+
+Usage:
+    centipede_bench [--out FILE]      write the JSON report to FILE (default stdout)
+                    [--min-time S]    rough seconds spent on each benchmark (default 0.2)
+                    [--filter TEXT]   only run benchmarks with TEXT in their name
+                    [--no-draw]       skip the draw benchmarks (they need a display)
+*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+#include "Centipede.hpp"
+#include "Collision.hpp"
+#include "Laser.hpp"
+#include "Mushrooms.hpp"
+#include "Settings.hpp"
+#include "Spider.hpp"
+#include "World.hpp"
+
+#ifdef CENTIPEDE_BENCH_DRAW
+#include <SFML/Graphics.hpp>
+
+#include "Player.hpp"
+#include "Renderer.hpp"
+#include "TextureManager.hpp"
+#endif
+
+namespace
+{
+
+/** Calls to the global allocator (counted by the replacement operator new) */
+std::atomic<std::uint64_t> allocationCount{0};
+
+/** A synthetic scene size */
+struct Scene
+{
+    std::size_t mushrooms;
+    int         segments;
+};
+
+/** From the size of a real game up to far larger than the screen could hold */
+constexpr std::array<Scene, 5> Scenes{{{30, 12}, {300, 100}, {3000, 1000}, {30000, 3000}, {100000, 10000}}};
+
+/** Number of lasers tested together by the batch collision benchmark */
+constexpr std::size_t VolleySize = 32;
+
+/** Fixed seed, so every run benchmarks the same scenes */
+constexpr std::uint32_t SceneSeed = 1981;
+
+/** Ticks played before counting allocations, and the most ticks counted */
+constexpr std::uint64_t WarmupTicks  = 60;
+constexpr std::uint64_t CountedTicks = 60 * 60;
+
+/** Command line options */
+struct Options
+{
+    std::string outPath;
+    double      minSeconds = 0.2;
+    std::string filter;
+    bool        draw = true;
+};
+
+/**
+ * Area of a scene, in whole grid cells.
+ * Wide enough for the whole centipede to start inside it (it starts in the middle, trailing right),
+ * and never smaller than the real game.
+ */
+FloatRect sceneBounds(const Scene& scene)
+{
+    const std::size_t columns = std::max<std::size_t>(30, 2 * static_cast<std::size_t>(scene.segments) + 2);
+    const std::size_t rows    = std::max<std::size_t>(30, 4 * scene.mushrooms / columns);
+    return {0, 0, static_cast<float>(columns) * Game::GridSize, static_cast<float>(rows) * Game::GridSize};
+}
+
+/**
+ * A collider inside the scene over cells without mushrooms, searched from the middle row down
+ * (the centipede starts in the top row). The mushroom checks scan its cells and find nothing,
+ * the centipede checks test every segment and miss.
+ */
+FloatRect missCollider(const MushroomManager& shroomMan, const FloatRect& bounds, Vec2f size)
+{
+    const int columns = static_cast<int>(bounds.width / Game::GridSize);
+    const int rows    = static_cast<int>(bounds.height / Game::GridSize);
+    for (int row = rows / 2; row < rows; row++)
+    {
+        for (int column = 1; column + 1 < columns; column++)
+        {
+            // the collider is centered on the cell, and can overlap both neighbours
+            const FloatRect collider = centeredRect({(static_cast<float>(column) + 0.5f) * Game::GridSize, (static_cast<float>(row) + 0.5f) * Game::GridSize}, size);
+            if (!shroomMan.hasShroom(column - 1, row) && !shroomMan.hasShroom(column, row) && !shroomMan.hasShroom(column + 1, row))
+            {
+                return collider;
+            }
+        }
+    }
+    throw std::runtime_error("No empty lane in the benchmark scene");
+}
+
+/** Mushroom nearest the middle of the scene, for the hit benchmarks */
+Vec2f hitTarget(const MushroomManager& shroomMan, const FloatRect& bounds)
+{
+    const Vec2f middle{bounds.left + bounds.width / 2.f, bounds.top + bounds.height / 2.f};
+    Vec2f       target   = shroomMan.getShrooms().front().getPosition();
+    float       distance = std::abs(target.x - middle.x) + std::abs(target.y - middle.y);
+    for (const Shroom& shroom : shroomMan.getShrooms())
+    {
+        const Vec2f position = shroom.getPosition();
+        const float d        = std::abs(position.x - middle.x) + std::abs(position.y - middle.y);
+        if (d < distance)
+        {
+            target   = position;
+            distance = d;
+        }
+    }
+    return target;
+}
+
+/** Collision and movement of the game objects, no SFML */
+void benchSimulation(Bench& bench)
+{
+    for (const Scene& scene : Scenes)
+    {
+        const FloatRect   bounds = sceneBounds(scene);
+        const std::size_t length = static_cast<std::size_t>(scene.segments);
+
+        MushroomManager shroomMan{bounds, SceneSeed, scene.mushrooms};
+        Centipede       centipede{bounds, shroomMan, scene.segments};
+
+        // a miss, in an empty lane of the field
+        const FloatRect laser = missCollider(shroomMan, bounds, Laser::Size);
+        bench.run("MushroomManager::checkLaserCollision", scene.mushrooms, length,
+                  [&] { return shroomMan.checkLaserCollision(laser); });
+
+        const FloatRect spider = missCollider(shroomMan, bounds, Spider::Size);
+        bench.run("MushroomManager::checkSpiderCollision", scene.mushrooms, length,
+                  [&] { return shroomMan.checkSpiderCollision(spider); });
+
+        // a hit, the mushroom is placed again whenever it is destroyed (every hit for the spider)
+        const Vec2f target = hitTarget(shroomMan, bounds);
+        const int   column = static_cast<int>(std::floor(target.x / Game::GridSize));
+        const int   row    = static_cast<int>(std::floor(target.y / Game::GridSize));
+        bench.run("MushroomManager::checkLaserCollision hit", scene.mushrooms, length, [&] {
+            const bool hit = shroomMan.checkLaserCollision(centeredRect(target, Laser::Size));
+            if (!shroomMan.hasShroom(column, row))
+            {
+                shroomMan.addMushroom(target);
+            }
+            return hit;
+        });
+
+        bench.run("MushroomManager::checkSpiderCollision hit", scene.mushrooms, length, [&] {
+            const bool hit = shroomMan.checkSpiderCollision(centeredRect(target, Spider::Size));
+            shroomMan.addMushroom(target);
+            return hit;
+        });
+
+        // copying the whole field, as a search or snapshot would
+        ShroomField field;
+        bench.run("ShroomField::copy", scene.mushrooms, length, [&] {
+            field = shroomMan.getField();
+            return field.getRows();
+        });
+
+        bench.run("Centipede::checkLaserCollision", scene.mushrooms, length, [&] { return centipede.checkLaserCollision(laser); });
+
+        // a volley of lasers spread across the middle of the scene, tested against every segment at once
+        std::vector<Collision::Edges> volley;
+        for (std::size_t i = 0; i < VolleySize; i++)
+        {
+            const float x = bounds.left + (static_cast<float>(i) + 0.5f) * bounds.width / static_cast<float>(VolleySize);
+            volley.push_back(Collision::toEdges(centeredRect({x, bounds.top + bounds.height / 2.f}, Laser::Size), Centipede::Subpixels));
+        }
+        const Segments&                segments = centipede.getSegments();
+        const Collision::CenteredBoxes boxes{segments.x.data(), segments.y.data(), segments.size(), Centipede::SegmentSubpixels, Centipede::SegmentSubpixels};
+        const std::size_t              words = Collision::maskWords(boxes.count);
+        std::vector<std::uint64_t>     masks(volley.size() * words);
+        bench.run("Collision::intersect", scene.mushrooms, length, [&] {
+            for (std::size_t i = 0; i < volley.size(); i++)
+            {
+                Collision::intersect(volley[i], boxes, masks.data() + i * words);
+            }
+            return masks[0];
+        });
+
+        bench.run("Centipede::checkMushroomCollision", scene.mushrooms, length, [&] {
+            centipede.checkMushroomCollision();
+            return centipede.getSegmentCount();
+        });
+
+        // one op moves every segment by one tick (they keep bouncing around the scene)
+        bench.run("Centipede::move", scene.mushrooms, length, [&] {
+            centipede.move(Game::Tick);
+            return centipede.getSegmentCount();
+        });
+    }
+
+    // the spider does not depend on the scene size
+    Spider spider{Game::SpiderArea, SceneSeed};
+    bench.run("Spider::update", 0, 0, [&] {
+        spider.update(Game::Tick);
+        return spider.isAlive();
+    });
+}
+
+/** A player that sweeps left and right, firing as fast as it can */
+Input scriptedInput(std::uint64_t tick)
+{
+    Input input;
+    input.fire  = true;
+    input.left  = (tick / 120) % 2 == 0;
+    input.right = !input.left;
+    return input;
+}
+
+/**
+ * Whole ticks of a real game. A new game is started whenever the player dies.
+ * Then the allocations of a fresh game are counted, after a warm-up: a steady tick
+ * only reuses storage, so this should be 0.
+ */
+void benchWorld(Bench& bench)
+{
+    auto          world = std::make_unique<World>(SceneSeed);
+    std::uint64_t tick  = 0;
+    bench.run("World::step", MushroomManager::StartCount, Centipede::MaxLength, [&] {
+        if (world->isOver())
+        {
+            world = std::make_unique<World>(SceneSeed + static_cast<std::uint32_t>(tick));
+        }
+        world->step(scriptedInput(tick++));
+        return world->getCentipede().getSegmentCount();
+    });
+
+    World counted{SceneSeed};
+    for (tick = 0; tick < WarmupTicks; tick++)
+    {
+        counted.step(scriptedInput(tick));
+    }
+    const std::uint64_t before = allocationCount.load();
+    std::uint64_t       ticks  = 0;
+    for (; ticks < CountedTicks && !counted.isOver(); ticks++)
+    {
+        counted.step(scriptedInput(tick++));
+    }
+    bench.count("World::step allocations", allocationCount.load() - before);
+    bench.count("World::step counted ticks", ticks);
+}
+
+#ifdef CENTIPEDE_BENCH_DRAW
+/**
+ * Draw calls of the Renderer, into an offscreen texture the size of the game.
+ * The view covers the whole scene, so every object lands on the texture.
+ * One op is the draw calls (flushing the batch) plus display().
+ */
+void benchDraw(Bench& bench)
+{
+    TextureManager texMan;
+    texMan.finishLoading();
+    Renderer renderer;
+
+    sf::RenderTexture target;
+    if (!target.create(static_cast<unsigned>(Game::GameSize.x), static_cast<unsigned>(Game::GameSize.y)))
+    {
+        throw std::runtime_error("Failed to create the benchmark render texture");
+    }
+
+    for (const Scene& scene : Scenes)
+    {
+        const FloatRect   bounds = sceneBounds(scene);
+        const std::size_t length = static_cast<std::size_t>(scene.segments);
+
+        MushroomManager shroomMan{bounds, SceneSeed, scene.mushrooms};
+        Centipede       centipede{bounds, shroomMan, scene.segments};
+        target.setView(sf::View{sf::FloatRect{bounds.left, bounds.top, bounds.width, bounds.height}});
+
+        shroomMan.setListener(&renderer);
+        bench.run("Renderer::drawMushrooms", scene.mushrooms, length, [&] {
+            renderer.drawMushrooms(target);
+            target.display();
+            return 0;
+        });
+
+        bench.run("Renderer::drawCentipede", scene.mushrooms, length, [&] {
+            renderer.drawCentipede(target, centipede);
+            renderer.flush();
+            target.display();
+            return 0;
+        });
+    }
+
+    // the other objects are always the same size
+    target.setView(target.getDefaultView());
+
+    const Spider spider{Game::SpiderArea, SceneSeed};
+    bench.run("Renderer::drawSpider", 0, 0, [&] {
+        renderer.drawSpider(target, spider);
+        renderer.flush();
+        target.display();
+        return 0;
+    });
+
+    const Player player{Game::PlayerArea};
+    bench.run("Renderer::drawPlayer", 0, 0, [&] {
+        renderer.drawPlayer(target, player);
+        renderer.flush();
+        target.display();
+        return 0;
+    });
+
+    // a full pool of lasers in flight
+    World::Lasers lasers;
+    for (std::size_t i = 0; i < lasers.size(); i++)
+    {
+        lasers[i].shoot(static_cast<float>(i) * Game::GridSize, Game::GameCenter.y);
+    }
+    bench.run("Renderer::drawLasers", 0, 0, [&] {
+        renderer.drawLasers(target, lasers);
+        renderer.flush();
+        target.display();
+        return 0;
+    });
+}
+
+/** SFML aborts without a display server on X11 systems, so check before making a context */
+bool hasDisplay()
+{
+#if defined(__unix__) && !defined(__APPLE__)
+    return std::getenv("DISPLAY") != nullptr;
+#else
+    return true;
+#endif
+}
+#endif
+
+} // namespace
+
+/** Counts every allocation, so benchWorld can check a steady tick makes none */
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        Options options;
+
+        for (int i = 1; i < argc; i++)
+        {
+            const bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--out") == 0 && hasValue)
+            {
+                options.outPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue)
+            {
+                options.minSeconds = std::stod(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--filter") == 0 && hasValue)
+            {
+                options.filter = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--no-draw") == 0)
+            {
+                options.draw = false;
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        Bench bench{options.minSeconds, options.filter};
+        benchSimulation(bench);
+        benchWorld(bench);
+
+#ifdef CENTIPEDE_BENCH_DRAW
+        if (options.draw && hasDisplay())
+        {
+            benchDraw(bench);
+        }
+        else if (options.draw)
+        {
+            std::cerr << "No display, skipping the draw benchmarks" << std::endl;
+        }
+#endif
+
+        if (options.outPath.empty())
+        {
+            bench.writeJson(std::cout);
+        }
+        else
+        {
+            std::ofstream out{options.outPath};
+            bench.writeJson(out);
+            if (!out)
+            {
+                std::cerr << "Failed to write " << options.outPath << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -6,88 +6,229 @@ Description:
 Centipede class definition.
 */
 
-#include <list>
-
-#include "SFML/Graphics.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
 
 #include "Centipede.hpp"
+#include "Collision.hpp"
 #include "Mushrooms.hpp"
 #include "Settings.hpp"
-#include "TextureManager.hpp"
+
+namespace
+{
+
+/** Segments further than this from the origin are rejected by restore (far from overflowing the integer math) */
+constexpr double MaxSubpixel = 1 << 28;
+
+/** Grid cell size (subpixels) */
+constexpr std::int32_t GridSubpixels = Game::GridSize * Centipede::Subpixels;
+
+/** Half the size of a segment (subpixels) */
+constexpr std::int32_t HalfSegment = Centipede::SegmentSubpixels / 2;
+
+/** 3px from anything is "collision" (subpixels) */
+constexpr std::int32_t Spacing = 3 * Centipede::Subpixels;
+
+/** @return `px` in the nearest whole subpixels */
+std::int32_t toSubpixels(float px)
+{
+    return static_cast<std::int32_t>(std::lround(static_cast<double>(px) * Centipede::Subpixels));
+}
+
+/** @return a / b rounded down (b > 0) */
+std::int32_t floorDiv(std::int32_t a, std::int32_t b)
+{
+    return a / b - (a % b < 0 ? 1 : 0);
+}
+
+/** Keep the elements of `values` whose `alive` flag is set, in order */
+template <typename T> void keepAlive(std::vector<T>& values, const std::vector<std::uint8_t>& alive)
+{
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        if (alive[i] != 0)
+        {
+            values[kept++] = values[i];
+        }
+    }
+    values.resize(kept);
+}
+
+/**
+ * One step of every segment's state machine (see Centipede::move).
+ * The arrays are restrict parameters (they never overlap), so the compiler needs no alias
+ * checks, and the selects are written as arithmetic on 0/1 flags, so the body has no branch.
+ * Both are needed for the loop to vectorize.
+ */
+void moveSegments(std::size_t count, std::int32_t* __restrict x, std::int32_t* __restrict y, std::uint8_t* __restrict direction, std::uint8_t* __restrict animation,
+                  std::uint8_t* __restrict flipped, const std::uint8_t* __restrict descending, std::int32_t distance, std::int32_t animStep)
+{
+    const auto none  = static_cast<std::uint8_t>(Centipede::Animation::None);
+    const auto mid1  = static_cast<std::uint8_t>(Centipede::Animation::Mid1);
+    const auto final = static_cast<std::uint8_t>(Centipede::Animation::Final);
+    const auto right = static_cast<std::uint8_t>(Centipede::Moving::Right);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        // straight along the row, or the collision animation (descend one row over 4 frames)
+        const std::uint8_t state    = animation[i];
+        const std::int32_t straight = state == none ? 1 : 0;
+        const std::int32_t xDisp    = animStep + straight * (distance - animStep);
+        const std::int32_t yDisp    = (1 - straight) * (2 * descending[i] - 1) * animStep;
+
+        // +1 moving right, -1 moving left
+        x[i] += (1 - 2 * (direction[i] ^ right)) * xDisp;
+        y[i] += yDisp;
+
+        // turn around halfway through the animation, and flip at the end
+        const std::uint8_t last = state == final ? 1 : 0;
+        direction[i]            = static_cast<std::uint8_t>(direction[i] ^ (state == mid1 ? 1 : 0));
+        flipped[i]              = static_cast<std::uint8_t>(flipped[i] ^ last);
+        animation[i]            = static_cast<std::uint8_t>((state + 1) * (1 - straight) * (1 - last));
+    }
+}
+
+} // namespace
+
+std::size_t Segments::size() const
+{
+    return x.size();
+}
+
+/** Every subpixel position is exact as a float (see MaxSubpixel) */
+Vec2f Segments::getPosition(std::size_t i) const
+{
+    return {static_cast<float>(x[i]) / Centipede::Subpixels, static_cast<float>(y[i]) / Centipede::Subpixels};
+}
 
 /**
  * Construct a new Centipede object.
- * Builds the list of segment objects and position them.
+ * Builds the first chain and positions it.
  */
-Centipede::Centipede(const sf::FloatRect& bounds, MushroomManager& shroomMan) : m_bounds{bounds}, m_shroomMan{shroomMan}
+Centipede::Centipede(const FloatRect& bounds, MushroomManager& shroomMan, int length)
+    : m_bounds{toSubpixels(bounds.left), toSubpixels(bounds.top), toSubpixels(bounds.left + bounds.width), toSubpixels(bounds.top + bounds.height)}, m_shroomMan{shroomMan}
 {
+    // split segments drop mushrooms anywhere they move
+    m_shroomMan.reserve(bounds);
 
     // set starting position of the head (center in the grid)
-    sf::Vector2f startPos{m_bounds.left + (m_bounds.width / 2.f), m_bounds.top + Game::GridSize / 2.f};
+    this->spawn({bounds.left + (bounds.width / 2.f), bounds.top + Game::GridSize / 2.f}, length);
+}
 
-    // construct the sprite segments in-place using  list iterator
-    for (int i = 0; i < Centipede::MaxLength; i++)
+/** The first segment is the head */
+void Centipede::spawn(Vec2f head, int length)
+{
+    const std::int32_t x = toSubpixels(head.x);
+    const std::int32_t y = toSubpixels(head.y);
+    for (int i = 0; i < length; i++)
     {
-        auto&       new_seg = m_segments.emplace_back(m_bounds);
-        const float spacing = static_cast<float>(Game::GridSize * i);
-        new_seg.setPosition(startPos.x + spacing, startPos.y);
+        this->push(x + GridSubpixels * i, y, i == 0);
     }
+}
 
-    // (Re)set the head texture
-    m_segments.front().setHead();
+void Centipede::push(std::int32_t x, std::int32_t y, bool head)
+{
+    m_segments.x.push_back(x);
+    m_segments.y.push_back(y);
+    m_segments.direction.push_back(static_cast<std::uint8_t>(Moving::Left));
+    m_segments.animation.push_back(static_cast<std::uint8_t>(Animation::None));
+    m_segments.descending.push_back(1);
+    m_segments.head.push_back(head ? 1 : 0);
+    m_segments.flipped.push_back(0);
+    m_segments.alive.push_back(1);
+    m_alive++;
+    m_laserHits.resize(Collision::maskWords(m_segments.size()));
 }
 
-/** Move the segment positions */
+/**
+ * Update the segment positions.
+ * Mushrooms don't change while segments move, so one collision pass before
+ * moving gives every segment the same result as checking right before its own move.
+ */
 void Centipede::update(float deltaTime)
 {
-    // move the segments
-    for (auto& seg : m_segments)
+    // holes are cleared out once they outnumber the living segments
+    if (m_segments.size() - m_alive > m_alive)
     {
-        this->checkMushroomCollision();
-        seg.update(deltaTime);
+        this->compact();
     }
+
+    this->checkMushroomCollision();
+    this->move(deltaTime);
 }
 
-/** Draw all segments to the screen */
-void Centipede::draw(sf::RenderTarget& target, sf::RenderStates states) const
+/**
+ * Move every segment according to its state machine.
+ * The loop is plain integer arithmetic over the arrays (see moveSegments), which the
+ * compiler vectorizes. Destroyed segments are moved too, nothing looks at them.
+ */
+void Centipede::move(float deltaTime)
 {
-    for (const auto& seg : m_segments)
-    {
-        target.draw(seg, states);
-    }
+    // Detect collisions with boundary edges,
+    // and update the state machine
+    this->detectEdgeCollisions();
+
+    const std::int32_t distance = toSubpixels(Centipede::Speed * deltaTime);
+    const std::int32_t animStep = toSubpixels(Centipede::AnimSpeed);
+
+    moveSegments(m_segments.size(), m_segments.x.data(), m_segments.y.data(), m_segments.direction.data(), m_segments.animation.data(), m_segments.flipped.data(),
+                 m_segments.descending.data(), distance, animStep);
+}
+
+/** Constant reference getter prevents modification */
+const Segments& Centipede::getSegments() const
+{
+    return m_segments;
+}
+
+std::size_t Centipede::getSegmentCount() const
+{
+    return m_alive;
 }
 
-/** Check all segments against all mushrooms
+/** Check all segments against the mushrooms
  *
- * This is technically O^2, but we can rule out a lot of cases
- * very quickly.
+ * Each segment looks up at most a single grid cell, so this is linear in segments.
  */
 void Centipede::checkMushroomCollision()
 {
-    for (auto& seg : m_segments)
+    for (std::size_t i = 0; i < m_segments.size(); i++)
     {
         // Don't check for collisions if currently in a downward animation
-        if (seg.isAnimating())
+        if (m_segments.alive[i] == 0 || m_segments.animation[i] != static_cast<std::uint8_t>(Animation::None))
         {
             continue;
         }
 
-        for (const auto& shroom : m_shroomMan.getShrooms())
+        if (this->detectMushroomCollision(i))
         {
-            seg.detectMushroomCollisions(shroom);
+            m_segments.animation[i] = static_cast<std::uint8_t>(Animation::Start);
         }
     }
 }
 
-bool Centipede::checkLaserCollision(sf::FloatRect laser)
+bool Centipede::checkLaserCollision(FloatRect laser)
 {
-    // find the first segment that this laser hits
-    for (auto seg = m_segments.begin(); seg != m_segments.end(); seg++)
+    // test every segment at once, then split the first living one that was hit
+    const Collision::CenteredBoxes boxes{m_segments.x.data(), m_segments.y.data(), m_segments.size(), SegmentSubpixels, SegmentSubpixels};
+    m_laserHits.resize(Collision::maskWords(boxes.count));
+    Collision::intersect(Collision::toEdges(laser, Centipede::Subpixels), boxes, m_laserHits.data());
+
+    for (std::size_t word = 0; word < m_laserHits.size(); word++)
     {
-        if (laser.intersects(seg->getGlobalBounds()))
+        std::uint64_t hits = m_laserHits[word];
+        for (std::size_t i = word * Collision::MaskBits; hits != 0; i++, hits >>= 1)
         {
-            this->splitAt(seg);
-            return true;
+            if ((hits & 1u) != 0 && m_segments.alive[i] != 0)
+            {
+                this->splitAt(i);
+                return true;
+            }
         }
     }
 
@@ -95,212 +236,183 @@ bool Centipede::checkLaserCollision(sf::FloatRect laser)
     return false;
 }
 
-void Centipede::splitAt(std::list<Segment>::iterator seg_it)
+/**
+ * Removing a segment only clears its alive flag. Chains end where the next head starts,
+ * so the tail becomes a new chain by flagging its first living segment as a head.
+ * Finding that segment walks over the holes right after `i`, so a split is O(holes), not O(1):
+ * compact() keeps the holes fewer than the living segments, and in a real game the walk is
+ * a few flags at most.
+ */
+void Centipede::splitAt(std::size_t i)
 {
     // Add a mushroom at the location of the destroyed segment
-    m_shroomMan.addMushroom(seg_it->getPosition());
-    // Remove hit sprite from the list, and destroy it
-    auto next = m_segments.erase(seg_it);
+    m_shroomMan.addMushroom(m_segments.getPosition(i));
+    // Remove hit segment
+    m_segments.alive[i] = 0;
+    m_segments.head[i]  = 0;
+    m_alive--;
+
+    // the next living segment, which trails in the same chain unless it is a head
+    std::size_t next = i + 1;
+    while (next < m_segments.size() && m_segments.alive[next] == 0)
+    {
+        next++;
+    }
 
-    // do nothing if we killed a tail segment
-    if (next == m_segments.end() || next->isHead())
+    // the next segment becomes a new head (or already is one if we killed a tail segment)
+    // (it sees the new mushroom in the collision pass of the next update)
+    if (next < m_segments.size())
     {
-        return;
+        m_segments.head[next] = 1;
     }
-    // otherwise, the next element becomes a new head
-    next->setHead();
-    // Force checking the mushrooms now
-    this->checkMushroomCollision();
 }
 
-/**
- * Segment constructor initializes base sf::Sprite and members.
- * Segments will have a centered origin, unlike SFML Sprites.
- */
-Segment::Segment(sf::FloatRect bounds) : m_bounds{bounds}
+void Centipede::compact()
 {
-    // All characters on the same sprite-sheet
-    const auto& tex = TextureManager::GetTexture("graphics/sprites.png");
-    this->setTexture(tex);
-    this->setTextureRect(Segment::BodyTexOffset);
-
-    const auto& size = this->getLocalBounds().getSize();
-    this->setOrigin(size.x / 2.f, size.y / 2.f);
+    // the alive flags are only rewritten last, every other array is compacted against them
+    const std::vector<std::uint8_t>& alive = m_segments.alive;
+    keepAlive(m_segments.x, alive);
+    keepAlive(m_segments.y, alive);
+    keepAlive(m_segments.direction, alive);
+    keepAlive(m_segments.animation, alive);
+    keepAlive(m_segments.descending, alive);
+    keepAlive(m_segments.head, alive);
+    keepAlive(m_segments.flipped, alive);
+    m_segments.alive.assign(m_alive, 1);
 }
 
-/** Move the segment according to the state machine */
-void Segment::update(float deltaTime)
+void Centipede::save(ByteWriter& out) const
 {
-    // Detect collisions with boundary edges,
-    // and update the state machine
-    this->detectEdgeCollisions();
+    out.varint(m_alive);
+    for (std::size_t i = 0; i < m_segments.size(); i++)
+    {
+        if (m_segments.alive[i] == 0)
+        {
+            continue;
+        }
+        out.vec(m_segments.getPosition(i));
+        out.byte(m_segments.direction[i]);
+        out.byte(m_segments.animation[i]);
+        out.flag(m_segments.descending[i] != 0);
+        out.flag(m_segments.head[i] != 0);
+        out.flag(m_segments.flipped[i] != 0);
+    }
+}
 
-    const float distance = Centipede::Speed * deltaTime;
+/**
+ * Enums are checked against their last value, so a corrupt snapshot can't produce an invalid state.
+ * Positions are saved in px, and must be whole subpixels.
+ */
+void Centipede::restore(ByteReader& in)
+{
+    m_segments = Segments{};
+    m_alive    = 0;
 
-    // Movement while going straight
-    if (m_animation == Animation::None)
+    const std::uint64_t count = in.varint();
+    for (std::uint64_t i = 0; i < count; i++)
     {
-        switch (m_direction)
+        const Vec2f         position   = in.vec();
+        const std::uint8_t  direction  = in.byteBelow(static_cast<std::uint8_t>(Moving::Left) + 1);
+        const std::uint8_t  animation  = in.byteBelow(static_cast<std::uint8_t>(Animation::Final) + 1);
+        const bool          descending = in.flag();
+        const bool          head       = in.flag();
+        const bool          flipped    = in.flag();
+        const double x = static_cast<double>(position.x) * Centipede::Subpixels;
+        const double y = static_cast<double>(position.y) * Centipede::Subpixels;
+        if (!(std::abs(x) <= MaxSubpixel && std::abs(y) <= MaxSubpixel) || std::floor(x) != x || std::floor(y) != y)
         {
-        case Moving::Right:
-            this->move(distance, 0.0);
-            break;
-        case Moving::Left:
-            this->move(-distance, 0.0);
-            break;
-        };
-    }
+            in.fail("Centipede segment off the subpixel grid in");
+        }
 
-    // Movement for the collision animation (descend one row over 4 frames)
-    const float yDisp = m_descending ? Centipede::AnimSpeed : -Centipede::AnimSpeed;
-    const float xDisp = m_direction == Moving::Right ? Centipede::AnimSpeed : -Centipede::AnimSpeed;
-
-    switch (m_animation)
-    { // TODO: set alternate animation intRects here
-    case Animation::Start:
-        this->move(xDisp, yDisp);
-        m_animation = Animation::Mid1;
-        break;
-    case Animation::Mid1:
-        this->move(xDisp, yDisp);
-        m_animation = Animation::Mid2;
-        m_direction = !m_direction;
-        break;
-    case Animation::Mid2:
-        this->move(xDisp, yDisp);
-        m_animation = Animation::Final;
-        break;
-    case Animation::Final:
-        this->move(xDisp, yDisp);
-        m_animation = Animation::None;
-        this->rotate(180);
-        break;
-    case Animation::None: // specifically do nothing if
-        break;            // not in an animation state
+        this->push(static_cast<std::int32_t>(x), static_cast<std::int32_t>(y), head);
+        m_segments.direction.back()  = direction;
+        m_segments.animation.back()  = animation;
+        m_segments.descending.back() = descending ? 1 : 0;
+        m_segments.flipped.back()    = flipped ? 1 : 0;
     }
 }
 
-/** Sets the state of the segment from colliding with the game edges */
-void Segment::detectEdgeCollisions()
+void Centipede::swap(Centipede& other)
 {
-    const float spacing = 3.0; // 3px from anything is "collision"
-
-    static const float width     = this->getLocalBounds().width;
-    const auto&        centerPos = this->getPosition();
+    std::swap(m_bounds, other.m_bounds);
+    std::swap(m_segments, other.m_segments);
+    std::swap(m_alive, other.m_alive);
+    std::swap(m_laserHits, other.m_laserHits);
+}
 
-    // Don't check for collisions if currently in a downward animation
-    if (m_animation != Animation::None)
+/** Sets the state of the segments from colliding with the game edges */
+void Centipede::detectEdgeCollisions()
+{
+    for (std::size_t i = 0; i < m_segments.size(); i++)
     {
-        return;
-    }
+        // Don't check for collisions if currently in a downward animation
+        if (m_segments.alive[i] == 0 || m_segments.animation[i] != static_cast<std::uint8_t>(Animation::None))
+        {
+            continue;
+        }
 
-    if (m_direction == Moving::Right)
-    {
-        if ((m_bounds.left + m_bounds.width) - this->getRightEdge().x <= spacing)
+        const std::int32_t x = m_segments.x[i];
+        const std::int32_t y = m_segments.y[i];
+
+        if (m_segments.direction[i] == static_cast<std::uint8_t>(Moving::Right))
         {
-            m_animation = Animation::Start;
+            if (m_bounds.right - (x + HalfSegment) <= Spacing)
+            {
+                m_segments.animation[i] = static_cast<std::uint8_t>(Animation::Start);
+            }
         }
-    }
-    else if (m_direction == Moving::Left)
-    {
-        if (this->getLeftEdge().x - m_bounds.left <= spacing)
+        else if ((x - HalfSegment) - m_bounds.left <= Spacing)
         {
-            m_animation = Animation::Start;
+            m_segments.animation[i] = static_cast<std::uint8_t>(Animation::Start);
         }
-    }
 
-    // after descending to the very bottom,
-    // bounce around in a 4 row area on the bottom (player area)
-    if (m_descending)
-    {
-        // hit bottom edge
-        if ((m_bounds.top + m_bounds.height) == (centerPos.y + width / 2))
+        // after descending to the very bottom,
+        // bounce around in a 4 row area on the bottom (player area)
+        if (m_segments.descending[i] != 0)
         {
-            m_descending = false;
+            // hit bottom edge
+            if (m_bounds.bottom == y + HalfSegment)
+            {
+                m_segments.descending[i] = 0;
+            }
         }
-    }
-    else
-    {
-        // ascending, hit top edge
-        if ((centerPos.y - width / 2) == m_bounds.top + m_bounds.height - Game::GridSize * 4)
+        else
         {
-            m_descending = true;
+            // ascending, hit top edge
+            if (y - HalfSegment == m_bounds.bottom - GridSubpixels * 4)
+            {
+                m_segments.descending[i] = 1;
+            }
         }
     }
 }
 
-/** Check for hitting a mushroom, and update state */
-bool Segment::detectMushroomCollisions(const Shroom& shroom)
+/**
+ * A mushroom within reach has its near edge between the segment edge and 3px further,
+ * mushroom edges are on the grid lines, so only the next grid line ahead can qualify.
+ * Most ticks the segment is mid-cell, and no lookup is needed at all.
+ */
+bool Centipede::detectMushroomCollision(std::size_t i) const
 {
-    const float spacing = 3.0; // 3px from anything is "collision"
-
-    const sf::Vector2f& segLeft  = this->getLeftEdge();
-    const sf::Vector2f& segRight = this->getRightEdge();
-
-    const sf::Vector2f& shroomLeft  = shroom.getLeftEdge();
-    const sf::Vector2f& shroomRight = shroom.getRightEdge();
-
-    // Skip mushrooms not on the same row (left and right y are the same)
-    if (segLeft.y != shroomLeft.y)
+    const std::int32_t x     = m_segments.x[i];
+    const std::int32_t y     = m_segments.y[i];
+    const bool         right = m_segments.direction[i] == static_cast<std::uint8_t>(Moving::Right);
+
+    // edge of the segment, and the next grid line ahead
+    const std::int32_t edge = right ? x + HalfSegment : x - HalfSegment;
+    const std::int32_t line = right ? -floorDiv(-edge, GridSubpixels) * GridSubpixels : floorDiv(edge, GridSubpixels) * GridSubpixels;
+    if (std::abs(line - edge) > Spacing)
     {
         return false;
     }
 
-    // Detect collisions and transistion segment to down state
-    if (m_direction == Moving::Right && shroomLeft.x >= segRight.x)
-    {
-        // Check right side of segment with left side of mushroom
-        if (shroomLeft.x - segRight.x <= spacing)
-        {
-            m_animation = Segment::Animation::Start;
-            return true;
-        }
-    }
-    else if (m_direction == Segment::Moving::Left && shroomRight.x <= segLeft.x)
+    // Skip segments that are not on the center of a row (mushrooms are), then test the bit of the cell past the line
+    const std::int32_t row = floorDiv(y, GridSubpixels);
+    if (y != row * GridSubpixels + GridSubpixels / 2 || !m_shroomMan.hasShroom(right ? line / GridSubpixels : line / GridSubpixels - 1, row))
     {
-        // Check left side of segment with right side of mushroom
-        if (segLeft.x - shroomRight.x <= spacing)
-        {
-            m_animation = Segment::Animation::Start;
-            return true;
-        }
+        return false;
     }
 
-    return false;
-}
-
-sf::Vector2f Segment::getRightEdge() const
-{
-    const float         width  = this->getLocalBounds().width;
-    const sf::Vector2f& center = this->getPosition();
-    return sf::Vector2f(center.x + width / 2.f, center.y);
-}
-
-sf::Vector2f Segment::getLeftEdge() const
-{
-    const float         width  = this->getLocalBounds().width;
-    const sf::Vector2f& center = this->getPosition();
-    return sf::Vector2f(center.x - width / 2.f, center.y);
-}
-
-void Segment::setHead()
-{
-    this->setTextureRect(Segment::HeadTexOffset);
-    m_isHead = true;
-}
-
-bool Segment::isHead()
-{
-    return m_isHead;
-}
-
-bool Segment::isAnimating()
-{
-    return m_animation != Animation::None;
-}
-
-/** Boolean NOT operator overload for easy direction switching */
-constexpr Segment::Moving operator!(const Segment::Moving& d) noexcept
-{
-    return d == Segment::Moving::Right ? Segment::Moving::Left : Segment::Moving::Right;
+    // Check the near side of the mushroom (the grid line) is ahead of the segment
+    return right ? line >= edge : line <= edge;
 }
@@ -8,101 +8,77 @@ Multiple Centipedes may be present in the game area with different segment lengt
 */
 
 #pragma once
-#include <list>
-
-#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
+#include "Collision.hpp"
+#include "Geometry.hpp"
 #include "Mushrooms.hpp"
+#include "Serialize.hpp"
 #include "Settings.hpp" // namespace Game
 
 /**
- * Each segment of the centipede acts independently from every other.
+ * State of every centipede segment, as parallel arrays: segment `i` is element `i` of each.
+ * Each segment acts independently from every other.
  * This allows me to more closely match the movement pattern of the original game.
  *
- * Segments inherit from sf::Sprite, adding extra functionality on top of being drawable.
+ * Positions are integers in Centipede::Subpixels units, so movement is exact and every
+ * comparison against the grid or the bounds is an integer comparison.
+ *
+ * Chains are stored one after the other, head first: a chain runs from its head to the
+ * next living head, so no chain ids are kept and a split only sets one head flag.
+ * A destroyed segment is left as a hole (alive = 0) until the Centipede compacts the
+ * arrays, so removing one never moves the others. Finding the head of the split-off tail
+ * skips the holes after it, O(holes) with the holes bounded by compaction.
  */
-class Segment : public sf::Sprite
+struct Segments
 {
-  public:
-    /**
-     * Construct a new Centipede Segment.
-     * Initializes the base-class and members.
-     * Constructed as normal body segments, set to the head texture with Segment::setHead()
-     *
-     * @param bounds The bounding area the Centipede can move in (for wall collisions)
-     */
-    Segment(sf::FloatRect bounds);
+    /** Center of each segment (subpixels) */
+    std::vector<std::int32_t> x;
+    std::vector<std::int32_t> y;
 
-    Segment() = delete; // no default constructor
+    /** Direction each segment is moving in (Centipede::Moving) */
+    std::vector<std::uint8_t> direction;
 
-    /** Enum to represent the direction the centipede is moving */
-    enum class Moving { Right, Left };
-    /** Enum for the states of colliding animation */
-    enum class Animation { None, Start, Mid1, Mid2, Final };
+    /** State of collision (Centipede::Animation). None represents not colliding */
+    std::vector<std::uint8_t> animation;
 
-    /** Move the segment according to it's current state */
-    void update(float deltaTime);
+    /** 1 while moving down the screen, 0 while bouncing back up in the player area */
+    std::vector<std::uint8_t> descending;
 
-    /** Check for hitting the bound edges, and update state */
-    void detectEdgeCollisions();
+    /** 1 for the head of a chain (drawn with the head texture), the first living segment of every chain */
+    std::vector<std::uint8_t> head;
 
-    /**
-     * Check if a segment will collide with a mushroom.
-     *
-     * Go into collision animation state if it does.
-     *
-     * @param shroom The mushroom to collide with
-     */
-    bool detectMushroomCollisions(const Shroom& shroom);
+    /** Toggled by every completed turn, the renderer rotates flipped segments 180 degrees */
+    std::vector<std::uint8_t> flipped;
 
-    /**
-     * Get the x,y position of the left edge for collisions
-     * @return sf::Vector2f
-     */
-    sf::Vector2f getLeftEdge() const;
-
-    /**
-     * Get the x,y position of the right edge for collisions
-     * @return sf::Vector2f
-     */
-    sf::Vector2f getRightEdge() const;
-
-    /** Mark this segment as a centipede head and change the sprite texture */
-    void setHead();
-
-    /** Check if this is a centipede head */
-    bool isHead();
+    /** 0 for a destroyed segment, which is skipped by everything */
+    std::vector<std::uint8_t> alive;
 
-    /** Check if this segment is currently in a collision animation */
-    bool isAnimating();
+    /** @return number of entries, destroyed segments included */
+    std::size_t size() const;
 
-  private:
-    // Texture positions
-    static inline const sf::IntRect HeadTexOffset{12, 43, 8, 8};   // head texture
-    static inline const sf::IntRect BodyTexOffset{116, 251, 8, 8}; // body texture
-
-    /** The current direction this segment is moving in */
-    Moving m_direction = Moving::Left;
-
-    /** The current state of collision. None represents not colliding */
-    Animation m_animation = Animation::None;
-
-    /** Bounding area of centipede movement (px) */
-    sf::FloatRect m_bounds;
-
-    bool m_descending = true;
-
-    /* Marks a segment as a head type*/
-    bool m_isHead = false;
+    /** @return the center of segment `i` (px) */
+    Vec2f getPosition(std::size_t i) const;
 };
 
 /**
- * A Centipede manages the std::list of sprite Segments.
- * It is the main controller and public interface for the Engine to interact with.
+ * A Centipede manages the Segments of every centipede chain.
+ * It is the main controller and public interface for the World to interact with.
  */
-class Centipede : public sf::Drawable
+class Centipede
 {
   public:
+    /** Size of every segment (px) */
+    static constexpr Vec2f SegmentSize{8, 8};
+
+    /** Units of the segment positions in a pixel */
+    static constexpr std::int32_t Subpixels = 16;
+
+    /** Width and height of every segment (subpixels) */
+    static constexpr std::int32_t SegmentSubpixels = static_cast<std::int32_t>(SegmentSize.x) * Subpixels;
+
     /** Moves at 15 grid cells per second (2 px/tick) */
     static constexpr float Speed = Game::GridSize * 15;
 
@@ -112,14 +88,20 @@ class Centipede : public sf::Drawable
     /** Starting number of Centipede segments */
     static constexpr int MaxLength = 12;
 
+    /** Enum to represent the direction the centipede is moving */
+    enum class Moving : std::uint8_t { Right, Left };
+    /** Enum for the states of colliding animation */
+    enum class Animation : std::uint8_t { None, Start, Mid1, Mid2, Final };
+
     /**
-     * Construct a new Centipede object with default length
+     * Construct a new Centipede object with a single chain
      *
      * @param shroomMan Reference to MushroomManager
                         for collision and adding new mushrooms (non-owned)
-     * @param bounds Bounding area for movement
+     * @param bounds Bounding area for movement (rounded to whole subpixels)
+     * @param length number of segments (longer centipedes are used by the benchmarks)
      */
-    Centipede(const sf::FloatRect& bounds, MushroomManager& shroomMan);
+    Centipede(const FloatRect& bounds, MushroomManager& shroomMan, int length = Centipede::MaxLength);
 
     // No copy constructor
     Centipede(const Centipede&) = delete;
@@ -127,44 +109,85 @@ class Centipede : public sf::Drawable
     // No copy assignment
     Centipede& operator=(const Centipede&) = delete;
 
-    /** Check all segments against all mushrooms to see if they collide */
+    /**
+     * Add a new chain, moving left with its body trailing to the right
+     * @param head center of the head segment
+     * @param length number of segments
+     */
+    void spawn(Vec2f head, int length);
+
+    /** Check all segments against the mushrooms ahead of them to see if they collide (once per update) */
     void checkMushroomCollision();
 
     /** Check if a laser hits any centipede segments*/
-    bool checkLaserCollision(sf::FloatRect laser);
+    bool checkLaserCollision(FloatRect laser);
 
     /** Update the centipede position based on elapsed seconds */
     void update(float deltaTime);
 
-    /** Draw all segments to the target window or texture */
-    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+    /** Move every segment one step, turning at the edges (mushrooms are checked by update()) */
+    void move(float deltaTime);
+
+    /**
+     * Get a reference to the segments for easy iteration
+     * @return read-only reference to the internal arrays (skip the segments that aren't alive)
+     */
+    const Segments& getSegments() const;
+
+    /** @return number of living segments */
+    std::size_t getSegmentCount() const;
+
+    /** Write every living segment to a snapshot */
+    void save(ByteWriter& out) const;
+
+    /** Replace every segment with the ones written by save() */
+    void restore(ByteReader& in);
+
+    /** Exchange every segment with `other` (each keeps its own MushroomManager) */
+    void swap(Centipede& other);
 
   private:
     /**
      * Split the centipede at the given segment, removing it.
      * A mushroom is added at the location of the removed segment.
-     * The next segment is changed to the head texture.
+     * The next segment of the chain becomes the head of a new chain.
      *
-     * @param seg_it iterator to the segment that was hit (killed)
+     * @param i index of the segment that was hit (killed)
      */
-    void splitAt(std::list<Segment>::iterator segment_it);
+    void splitAt(std::size_t i);
 
-    /** The area of movement */
-    sf::FloatRect m_bounds;
+    /**
+     * Check if a segment will collide with a mushroom.
+     * Mushrooms sit on the grid, so only the occupancy bit of the cell just ahead is tested.
+     *
+     * @param i index of the segment
+     * @return true if the segment is about to hit a mushroom
+     */
+    bool detectMushroomCollision(std::size_t i) const;
+
+    /** Start a turn for segments at the bound edges, and update their vertical direction */
+    void detectEdgeCollisions();
+
+    /** Append a segment, centered on (x, y) subpixels */
+    void push(std::int32_t x, std::int32_t y, bool head);
+
+    /** Remove the holes left by destroyed segments, keeping the order */
+    void compact();
+
+    /** The area of movement (subpixels) */
+    Collision::Edges m_bounds;
 
     /** Reference to the mushrooms so we can collide and generate more when split.
      * Aggregate member (not owned).
      */
     MushroomManager& m_shroomMan;
 
-    /** All of the segments that make up this centipede.
-     * The first element is always the head sprite. The other's trail behind. */
-    std::list<Segment> m_segments;
-};
+    /** All of the segments that make up every centipede */
+    Segments m_segments;
 
-/**
- * Override the boolean inversion operator to easily switch directions
- * @param dir Moving::Right or Moving::Left
- * @return Opposite direction of `dir`
- */
-constexpr Segment::Moving operator!(const Segment::Moving& dir) noexcept;
+    /** Number of living segments */
+    std::size_t m_alive = 0;
+
+    /** Hit mask of the last laser test, sized as segments are added so the test never allocates */
+    std::vector<std::uint64_t> m_laserHits;
+};
@@ -0,0 +1,231 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Batch rectangle intersection kernels, and the runtime choice between them.
+The boxes are integers, so every kernel computes exactly the same edges and
+comparisons, and they all agree to the bit.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "Collision.hpp"
+
+// SSE2 is part of x86-64, AVX2 is compiled per function and only used if the CPU has it
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CENTIPEDE_COLLISION_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+/** Signature shared by every kernel */
+using KernelFn = void (*)(const Collision::Edges& rect, const Collision::CenteredBoxes& boxes, std::uint64_t* masks);
+
+/** @return `value` rounded down, clamped to the range of the boxes (no libm call) */
+std::int32_t floorUnits(double value)
+{
+    const double clamped = std::clamp(value, static_cast<double>(INT32_MIN), static_cast<double>(INT32_MAX));
+    const auto   whole   = static_cast<std::int32_t>(clamped);
+    return whole > clamped ? whole - 1 : whole;
+}
+
+/** @return `value` rounded up, clamped to the range of the boxes */
+std::int32_t ceilUnits(double value)
+{
+    const double clamped = std::clamp(value, static_cast<double>(INT32_MIN), static_cast<double>(INT32_MAX));
+    const auto   whole   = static_cast<std::int32_t>(clamped);
+    return whole < clamped ? whole + 1 : whole;
+}
+
+/** Test the boxes in [first, count) one at a time */
+void intersectTail(const Collision::Edges& rect, const Collision::CenteredBoxes& boxes, std::size_t first, std::uint64_t* masks)
+{
+    for (std::size_t i = first; i < boxes.count; i++)
+    {
+        const std::int32_t left = boxes.x[i] - boxes.width / 2;
+        const std::int32_t top  = boxes.y[i] - boxes.height / 2;
+        if (rect.left < left + boxes.width && left < rect.right && rect.top < top + boxes.height && top < rect.bottom)
+        {
+            masks[i / Collision::MaskBits] |= std::uint64_t{1} << (i % Collision::MaskBits);
+        }
+    }
+}
+
+void intersectScalar(const Collision::Edges& rect, const Collision::CenteredBoxes& boxes, std::uint64_t* masks)
+{
+    std::fill_n(masks, Collision::maskWords(boxes.count), std::uint64_t{0});
+    intersectTail(rect, boxes, 0, masks);
+}
+
+#ifdef CENTIPEDE_COLLISION_X86
+/** 4 boxes at a time */
+void intersectSse2(const Collision::Edges& rect, const Collision::CenteredBoxes& boxes, std::uint64_t* masks)
+{
+    std::fill_n(masks, Collision::maskWords(boxes.count), std::uint64_t{0});
+
+    const __m128i rectLeft   = _mm_set1_epi32(rect.left);
+    const __m128i rectRight  = _mm_set1_epi32(rect.right);
+    const __m128i rectTop    = _mm_set1_epi32(rect.top);
+    const __m128i rectBottom = _mm_set1_epi32(rect.bottom);
+    const __m128i halfWidth  = _mm_set1_epi32(boxes.width / 2);
+    const __m128i halfHeight = _mm_set1_epi32(boxes.height / 2);
+    const __m128i width      = _mm_set1_epi32(boxes.width);
+    const __m128i height     = _mm_set1_epi32(boxes.height);
+
+    std::size_t i = 0;
+    for (; i + 4 <= boxes.count; i += 4)
+    {
+        const __m128i left = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(boxes.x + i)), halfWidth);
+        const __m128i top  = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(boxes.y + i)), halfHeight);
+
+        const __m128i horizontal = _mm_and_si128(_mm_cmpgt_epi32(_mm_add_epi32(left, width), rectLeft), _mm_cmpgt_epi32(rectRight, left));
+        const __m128i vertical   = _mm_and_si128(_mm_cmpgt_epi32(_mm_add_epi32(top, height), rectTop), _mm_cmpgt_epi32(rectBottom, top));
+
+        const auto hits = static_cast<std::uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(horizontal, vertical))));
+        masks[i / Collision::MaskBits] |= hits << (i % Collision::MaskBits);
+    }
+    intersectTail(rect, boxes, i, masks);
+}
+
+/** 8 boxes at a time */
+__attribute__((target("avx2"))) void intersectAvx2(const Collision::Edges& rect, const Collision::CenteredBoxes& boxes, std::uint64_t* masks)
+{
+    std::fill_n(masks, Collision::maskWords(boxes.count), std::uint64_t{0});
+
+    const __m256i rectLeft   = _mm256_set1_epi32(rect.left);
+    const __m256i rectRight  = _mm256_set1_epi32(rect.right);
+    const __m256i rectTop    = _mm256_set1_epi32(rect.top);
+    const __m256i rectBottom = _mm256_set1_epi32(rect.bottom);
+    const __m256i halfWidth  = _mm256_set1_epi32(boxes.width / 2);
+    const __m256i halfHeight = _mm256_set1_epi32(boxes.height / 2);
+    const __m256i width      = _mm256_set1_epi32(boxes.width);
+    const __m256i height     = _mm256_set1_epi32(boxes.height);
+
+    std::size_t i = 0;
+    for (; i + 8 <= boxes.count; i += 8)
+    {
+        const __m256i left = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(boxes.x + i)), halfWidth);
+        const __m256i top  = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(boxes.y + i)), halfHeight);
+
+        const __m256i horizontal = _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_add_epi32(left, width), rectLeft), _mm256_cmpgt_epi32(rectRight, left));
+        const __m256i vertical   = _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_add_epi32(top, height), rectTop), _mm256_cmpgt_epi32(rectBottom, top));
+
+        // 8 lanes never straddle a word, the blocks start at multiples of 8
+        const auto hits = static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(horizontal, vertical))));
+        masks[i / Collision::MaskBits] |= hits << (i % Collision::MaskBits);
+    }
+    // GCC emits no vzeroupper before the SSE tail
+    _mm256_zeroupper();
+    intersectTail(rect, boxes, i, masks);
+}
+#endif
+
+/** Pick the widest kernel this CPU runs */
+KernelFn pickKernel()
+{
+#ifdef CENTIPEDE_COLLISION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return intersectAvx2;
+    }
+    return intersectSse2;
+#else
+    return intersectScalar;
+#endif
+}
+
+/** The kernel used by every test, picked on first use */
+KernelFn kernel()
+{
+    static const KernelFn picked = pickKernel();
+    return picked;
+}
+
+} // namespace
+
+namespace Collision
+{
+
+/**
+ * A box edge B (whole units) passes rect.left < B exactly when floor(left) < B,
+ * and B < rect.right exactly when B < ceil(right). The edges are scaled as doubles,
+ * which is exact for a float times any scale below 2^29.
+ */
+Edges toEdges(const FloatRect& rect, std::int32_t scale)
+{
+    const double units = scale;
+    return {floorUnits(rect.left * units), floorUnits(rect.top * units), ceilUnits((rect.left + rect.width) * units), ceilUnits((rect.top + rect.height) * units)};
+}
+
+void intersect(const Edges& rect, const CenteredBoxes& boxes, std::uint64_t* masks)
+{
+    kernel()(rect, boxes, masks);
+}
+
+const char* kernelName()
+{
+    const KernelFn picked = kernel();
+#ifdef CENTIPEDE_COLLISION_X86
+    if (picked == intersectAvx2)
+    {
+        return "avx2";
+    }
+    if (picked == intersectSse2)
+    {
+        return "sse2";
+    }
+#endif
+    return picked == intersectScalar ? "scalar" : "unknown";
+}
+
+bool hasKernel(Kernel kernel)
+{
+    switch (kernel)
+    {
+#ifdef CENTIPEDE_COLLISION_X86
+    case Kernel::Avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    case Kernel::Sse2:
+        return true;
+#else
+    case Kernel::Avx2:
+    case Kernel::Sse2:
+        return false;
+#endif
+    case Kernel::Scalar:
+        return true;
+    }
+    return false;
+}
+
+void intersect(Kernel kernel, const Edges& rect, const CenteredBoxes& boxes, std::uint64_t* masks)
+{
+    if (!hasKernel(kernel))
+    {
+        throw std::runtime_error("Collision kernel not supported by this CPU");
+    }
+    switch (kernel)
+    {
+#ifdef CENTIPEDE_COLLISION_X86
+    case Kernel::Avx2:
+        intersectAvx2(rect, boxes, masks);
+        return;
+    case Kernel::Sse2:
+        intersectSse2(rect, boxes, masks);
+        return;
+#endif
+    default:
+        intersectScalar(rect, boxes, masks);
+        return;
+    }
+}
+
+} // namespace Collision
@@ -0,0 +1,89 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Batch rectangle intersection tests.
+Tests rectangles against packed arrays of boxes in integer (fixed-point) coordinates,
+several boxes at a time with SSE2/AVX2 when the CPU has them, and returns which boxes
+were hit as bit masks.
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "Geometry.hpp"
+
+namespace Collision
+{
+
+/**
+ * Boxes of one size, packed as parallel arrays of their centers.
+ * Box `i` spans x[i] - width / 2 to x[i] - width / 2 + width (and the same vertically).
+ */
+struct CenteredBoxes
+{
+    const std::int32_t* x      = nullptr;
+    const std::int32_t* y      = nullptr;
+    std::size_t         count  = 0;
+    std::int32_t        width  = 0;
+    std::int32_t        height = 0;
+};
+
+/** A rectangle given by its edges, in the same units as the boxes */
+struct Edges
+{
+    std::int32_t left   = 0;
+    std::int32_t top    = 0;
+    std::int32_t right  = 0;
+    std::int32_t bottom = 0;
+};
+
+/**
+ * Convert a rectangle to the fixed-point units of the boxes.
+ * The edges are rounded outwards, which gives the same answers as rect.intersects(box)
+ * for any box whose edges are whole units.
+ *
+ * @param rect rectangle in pixels
+ * @param scale units per pixel
+ */
+Edges toEdges(const FloatRect& rect, std::int32_t scale);
+
+/** Number of boxes in each word of a hit mask */
+constexpr std::size_t MaskBits = 64;
+
+/** @return number of words in the hit mask of `count` boxes */
+constexpr std::size_t maskWords(std::size_t count) noexcept
+{
+    return (count + MaskBits - 1) / MaskBits;
+}
+
+/**
+ * Test one rectangle against every box.
+ * Touching edges do not count as overlapping (same as FloatRect::intersects).
+ *
+ * @param rect rectangle to test
+ * @param boxes boxes to test against
+ * @param masks maskWords(boxes.count) words, bit `i % 64` of word `i / 64` is set if box `i` is hit
+ */
+void intersect(const Edges& rect, const CenteredBoxes& boxes, std::uint64_t* masks);
+
+/** @return name of the kernel picked for this CPU ("avx2", "sse2" or "scalar") */
+const char* kernelName();
+
+/** Every kernel, narrowest first */
+enum class Kernel { Scalar, Sse2, Avx2 };
+
+/** @return true if this build and CPU can run `kernel` */
+bool hasKernel(Kernel kernel);
+
+/**
+ * Test one rectangle against every box with a given kernel, instead of the one picked
+ * for this CPU (so the tests can check every kernel gives the same masks)
+ *
+ * @throws std::runtime_error if hasKernel(kernel) is false
+ */
+void intersect(Kernel kernel, const Edges& rect, const CenteredBoxes& boxes, std::uint64_t* masks);
+
+} // namespace Collision
@@ -0,0 +1,116 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Controls definition: key-state table and action bindings.
+*/
+
+#include <SFML/Window.hpp>
+
+#include "Controls.hpp"
+
+static_assert(static_cast<std::size_t>(Controls::Action::Count) <= 8, "action masks are one byte");
+
+/** Can be moved with arrows or WASD, and shoot with Space */
+Controls::Controls()
+{
+    this->bind(Action::Up, {sf::Keyboard::W, sf::Keyboard::Up});
+    this->bind(Action::Down, {sf::Keyboard::S, sf::Keyboard::Down});
+    this->bind(Action::Left, {sf::Keyboard::A, sf::Keyboard::Left});
+    this->bind(Action::Right, {sf::Keyboard::D, sf::Keyboard::Right});
+    this->bind(Action::Fire, {sf::Keyboard::Space});
+}
+
+/** Held counts are rebuilt, so rebinding while keys are down stays consistent */
+void Controls::bind(Action action, const std::vector<sf::Keyboard::Key>& keys)
+{
+    const std::uint8_t mask = Controls::bit(action);
+    for (auto& actions : m_actions)
+    {
+        actions &= static_cast<std::uint8_t>(~mask);
+    }
+    for (const auto key : keys)
+    {
+        if (key > sf::Keyboard::Unknown && key < sf::Keyboard::KeyCount)
+        {
+            m_actions[static_cast<std::size_t>(key)] |= mask;
+        }
+    }
+
+    int held = 0;
+    for (std::size_t key = 0; key < KeyCount; key++)
+    {
+        held += (m_keys[key] && (m_actions[key] & mask) != 0) ? 1 : 0;
+    }
+    m_held[static_cast<std::size_t>(action)] = held;
+}
+
+void Controls::handle(const sf::Event& event)
+{
+    switch (event.type)
+    {
+    case sf::Event::KeyPressed:
+        this->setKey(event.key.code, true);
+        break;
+    case sf::Event::KeyReleased:
+        this->setKey(event.key.code, false);
+        break;
+    case sf::Event::LostFocus:
+        this->releaseAll();
+        break;
+    default:
+        break;
+    }
+}
+
+void Controls::releaseAll()
+{
+    m_keys.fill(false);
+    m_held.fill(0);
+}
+
+bool Controls::isHeld(Action action) const
+{
+    return m_held[static_cast<std::size_t>(action)] > 0;
+}
+
+Input Controls::getInput() const
+{
+    Input input;
+    input.up    = this->isHeld(Action::Up);
+    input.down  = this->isHeld(Action::Down);
+    input.left  = this->isHeld(Action::Left);
+    input.right = this->isHeld(Action::Right);
+    input.fire  = this->isHeld(Action::Fire);
+    return input;
+}
+
+std::uint8_t Controls::bit(Action action)
+{
+    return static_cast<std::uint8_t>(1u << static_cast<std::size_t>(action));
+}
+
+/** Repeated presses (key repeat) and unknown keys are ignored */
+void Controls::setKey(sf::Keyboard::Key key, bool held)
+{
+    if (key <= sf::Keyboard::Unknown || key >= sf::Keyboard::KeyCount)
+    {
+        return;
+    }
+
+    const auto index = static_cast<std::size_t>(key);
+    if (m_keys[index] == held)
+    {
+        return;
+    }
+    m_keys[index] = held;
+
+    for (std::size_t action = 0; action < ActionCount; action++)
+    {
+        if ((m_actions[index] & Controls::bit(static_cast<Action>(action))) != 0)
+        {
+            m_held[action] += held ? 1 : -1;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Declare the Controls, a key-state table with rebindable player actions.
+*/
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <SFML/Window.hpp>
+
+#include "Input.hpp"
+
+/**
+ * Tracks which keys are held from the KeyPressed/KeyReleased events the Engine
+ * already polls, so reading the player controls never queries the OS.
+ *
+ * Keys are bound to Actions. Each key stores a bit mask of its actions, and each
+ * action counts how many of its keys are held, so events and reads are both O(1).
+ */
+class Controls
+{
+  public:
+    /** Things the player can do */
+    enum class Action : std::size_t { Up, Down, Left, Right, Fire, Count };
+
+    /** Construct with the default bindings (WASD or arrow keys to move, Space to fire) */
+    Controls();
+
+    /**
+     * Replace the keys bound to an action
+     * @param action the action to rebind
+     * @param keys every key that triggers it (a key may trigger several actions)
+     */
+    void bind(Action action, const std::vector<sf::Keyboard::Key>& keys);
+
+    /** Update the key states from a window event (other events are ignored) */
+    void handle(const sf::Event& event);
+
+    /** Forget every held key (e.g. the window lost focus and won't see the releases) */
+    void releaseAll();
+
+    /** @return true if any key bound to the action is held */
+    bool isHeld(Action action) const;
+
+    /** @return the player controls for the next tick */
+    Input getInput() const;
+
+  private:
+    /** Number of actions */
+    static constexpr std::size_t ActionCount = static_cast<std::size_t>(Action::Count);
+
+    /** Number of keys SFML knows about */
+    static constexpr std::size_t KeyCount = sf::Keyboard::KeyCount;
+
+    /** Bit of an action in a key's mask */
+    static std::uint8_t bit(Action action);
+
+    /** Set a key as held or released, updating the action counts */
+    void setKey(sf::Keyboard::Key key, bool held);
+
+    /** Which keys are held */
+    std::array<bool, KeyCount> m_keys{};
+
+    /** Which actions each key triggers (one bit per action) */
+    std::array<std::uint8_t, KeyCount> m_actions{};
+
+    /** Number of held keys bound to each action */
+    std::array<int, ActionCount> m_held{};
+};
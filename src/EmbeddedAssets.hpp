@@ -0,0 +1,24 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Declare the images compiled into the game (generated by tools/embed_assets.cpp at build time).
+*/
+
+#pragma once
+#include <cstdint>
+
+/** A decoded image, 4 bytes (RGBA) per pixel, rows top to bottom */
+struct EmbeddedImage
+{
+    unsigned            width;
+    unsigned            height;
+    const std::uint8_t* pixels;
+};
+
+/** graphics/sprites.png, the sprite-sheet of the original game */
+extern const EmbeddedImage EmbeddedSprites;
+
+/** graphics/splash.png, the start screen */
+extern const EmbeddedImage EmbeddedSplash;
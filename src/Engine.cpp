@@ -5,7 +5,11 @@ Copyright (c) 2024 Jackson Miller
 Description:
 Defines the main game Engine and game loop logic.
 */
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <random>
+#include <stdexcept>
 
 #include <SFML/Graphics.hpp>
 
@@ -16,46 +20,51 @@ Defines the main game Engine and game loop logic.
  * Construct a new Engine:: Engine object
  *
  * Initializer list handles creating member objects.
- * Body sets window and view settings
+ * Body sets window, view and frame settings
  */
 Engine::Engine()
     : texMan(),
-      m_view{Game::GameCenter, Game::GameSize},
-      m_player{Game::PlayerArea},
-      m_shroomMan{Game::ShroomArea},
-      m_centipede{Game::EnemyArea, m_shroomMan},
-      m_spider{Game::SpiderArea},
-      m_totalGameTime{sf::Time::Zero},
-      m_lastFired{sf::Time::Zero}
+      m_view{{Game::GameCenter.x, Game::GameCenter.y}, {Game::GameSize.x, Game::GameSize.y}},
+      m_world(std::make_unique<World>(std::random_device{}())),
+      m_renderer()
 {
+    m_renderer.watch(*m_world);
 
-    // calculate the window size to be 3/4 of available height
+    const auto width  = static_cast<uint>(Game::GameSize.x);
+    const auto height = static_cast<uint>(Game::GameSize.y);
+    if (!m_frame.create(width, height))
+    {
+        throw std::runtime_error("Failed to create the frame texture");
+    }
+    m_frame.setView(m_view);
+    m_blit.setTexture(m_frame.getTexture(), true);
 
-    const auto& desktop   = sf::VideoMode::getDesktopMode();
-    const uint  maxHeight = 3 * (desktop.height / 4);
+    // the largest whole multiple of the game size that fits in 3/4 of available height
 
-    const float gameRatio = Game::GameSize.x / Game::GameSize.y;
-    const uint  maxWidth  = static_cast<uint>(gameRatio * static_cast<float>(maxHeight));
+    const auto& desktop = sf::VideoMode::getDesktopMode();
+    const uint  scale   = std::max(1u, 3 * (desktop.height / 4) / height);
 
-    sf::VideoMode windowSize{maxWidth, maxHeight};
+    sf::VideoMode windowSize{scale * width, scale * height};
 
     // (re)create the window (allow resizing)
     m_window.create(windowSize, Game::Name, sf::Style::Default);
 
     // set some OS window options
     m_window.setMouseCursorVisible(false);
-    m_window.setFramerateLimit(60); // original game was 60fps
-    m_window.setVerticalSyncEnabled(false);
+    m_window.setVerticalSyncEnabled(false); // the FramePacer limits the frame rate
+    m_window.setKeyRepeatEnabled(false);    // held keys are tracked by m_controls
 
     // place the window in the center of the desktop
     const auto xpos = (desktop.width / 2u) - (m_window.getSize().x / 2u);
     const auto ypos = (desktop.height / 2u) - (m_window.getSize().y / 2u);
     m_window.setPosition(sf::Vector2i(static_cast<int>(xpos), static_cast<int>(ypos)));
 
-    m_window.setView(m_view);
+    this->setViewport(m_window.getSize().x, m_window.getSize().y);
+
+    texMan.finishLoading();
 
     // made my own startup image
-    m_startSprite.setTexture(TextureManager::GetTexture("graphics/splash.png"));
+    m_startSprite.setTexture(TextureManager::GetTexture(TextureId::Splash));
 
     // later as a HUD overlay (not submitted)
     // m_border.setSize(Game::GameSize);
@@ -74,33 +83,129 @@ void Engine::run()
     {
         throw std::runtime_error("Shaders are not available");
     }
-    // reset the clock for first run
-    m_clock.restart();
+    // original game was 60fps, the pacer steps one tick per 1/60s of real time
+    m_pacer.reset();
     while (m_window.isOpen())
     {
-        const sf::Time& dt = m_clock.restart();
-        m_totalGameTime += dt;
-        m_elapsedTime += dt.asSeconds();
-        constexpr float tick = 1 / 60.f;
-
-        // only draw frames at a maximum tick rate
         input();
-        if (m_elapsedTime >= tick)
+
+        const unsigned ticks = m_pacer.advance();
+        for (unsigned i = 0; i < ticks; i++)
+        {
+            update();
+        }
+
+        if (m_pacer.shouldDraw(ticks))
         {
-            update(tick);
             draw();
-            m_elapsedTime = 0;
+#ifdef CENTIPEDE_PROFILING
+            m_profiler.endFrame();
+#endif
         }
+
+        // sleep until the next tick or frame is due
+        m_pacer.wait();
+    }
+
+    if (m_pacer.getDroppedTicks() > 0)
+    {
+        std::cout << "Dropped " << m_pacer.getDroppedTicks() << " ticks while catching up" << std::endl;
+    }
+
+    // keep a game that was cut short
+    if (m_recording)
+    {
+        this->endGame();
+    }
+
+#ifdef CENTIPEDE_PROFILING
+    this->reportTimings();
+#endif
+
+    if (m_latency)
+    {
+        m_latency->report(std::cout);
+    }
+}
+
+void Engine::setSeed(std::uint32_t seed)
+{
+    m_seed = seed;
+}
+
+void Engine::recordTo(const std::string& path)
+{
+    m_recordPath = path;
+}
+
+/** Playback starts straight away, skipping the start screen */
+void Engine::replay(Replay replay)
+{
+    m_playback = std::move(replay);
+    this->startGame(m_playback->getSeed());
+}
+
+void Engine::setPacing(const FramePacer::Settings& settings)
+{
+    m_pacer = FramePacer{settings};
+}
+
+Controls& Engine::getControls()
+{
+    return m_controls;
+}
+
+void Engine::measureLatency()
+{
+    m_latency.emplace();
+}
+
+sf::Image Engine::capture() const
+{
+    return m_frame.getTexture().copyToImage();
+}
+
+/** Every game is played in a new World, so it can be recorded from its first tick */
+void Engine::startGame(std::uint32_t seed)
+{
+    m_world = std::make_unique<World>(seed);
+    m_renderer.watch(*m_world);
+    m_tick  = 0;
+#ifdef CENTIPEDE_PROFILING
+    m_world->setProfiler(&m_profiler);
+#endif
+    if (!m_recordPath.empty())
+    {
+        m_recording.emplace(seed);
+    }
+
+    state = State::Playing;
+    std::cout << "Started (seed " << seed << ")" << std::endl;
+    m_pacer.reset(); // forget the time spent on the start screen, to prevent frame skip
+}
+
+void Engine::endGame()
+{
+    state = State::Start;
+    m_playback.reset();
+    if (m_recording)
+    {
+        m_recording->save(m_recordPath);
+        std::cout << "Saved replay to " << m_recordPath << std::endl;
+        m_recording.reset();
     }
 }
 
 /**
  * Handle event input (start/stop/quit),
- * player movement input (from Player::handleInput()),
+ * player movement input (WASD or arrow keys),
  * as well as shooting lasers with <SPACE>.
  */
 void Engine::input()
 {
+    // input is polled many times per frame, the timer adds them all up
+    CENTIPEDE_PROFILE(&m_profiler, Phase::Input);
+
     // handle event polling for some inputs (start/end, etc)
     sf::Event event;
     while (m_window.pollEvent(event))
@@ -112,6 +217,15 @@ void Engine::input()
             m_window.close();
         }
 
+        // held keys for smooth player movement (no per-frame keyboard queries)
+        m_controls.handle(event);
+
+        // stamp key events as soon as they are seen, only those that will steer a game
+        if (m_latency && state == State::Playing && !m_playback && (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased))
+        {
+            m_latency->observe();
+        }
+
         // preserve the aspect ratio when resizing
         if (event.type == sf::Event::Resized)
         {
@@ -124,12 +238,7 @@ void Engine::input()
             // Start game from "menu" with "ENTER"
             if (state == State::Start && (event.key.code == sf::Keyboard::Return || event.key.code == sf::Keyboard::Space))
             {
-
-                state = State::Playing;
-                std::cout << "Started" << std::endl;
-                m_clock.restart(); // restart clock to prevent frame skip
-
-                m_player.spawn(); // respawn the player if they are dead
+                this->startGame(m_seed ? *m_seed : std::random_device{}());
             }
 
             // Quit game whenever "ESC" pressed
@@ -138,42 +247,30 @@ void Engine::input()
                 std::cout << "Ended" << std::endl;
                 m_window.close();
             }
-        }
-    } // end event polling
-
-    // Keyboard polling for smooth player movement
-    if (state == State::Playing)
-    {
-
-        // Handle player movement with WASD keys
-        m_player.handleInput();
 
-        // Handle shooting lasers (TODO: move to Player (?) probably)
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space))
-        {
-            auto elapsed = m_totalGameTime.asMilliseconds() - m_lastFired.asMilliseconds();
+            // save the frame as the game drew it (not the scaled window)
+            if (event.key.code == sf::Keyboard::F12 && this->capture().saveToFile(Engine::CapturePath))
+            {
+                std::cout << "Saved frame to " << Engine::CapturePath << std::endl;
+            }
 
-            // only fire after the firing period has elapsed
-            if (elapsed > static_cast<int>(1000 / Laser::FireRate))
+#ifdef CENTIPEDE_PROFILING
+            // show/hide the frame timings
+            if (event.key.code == sf::Keyboard::F3)
             {
-                m_lasers[m_currentLaser].shoot(m_player.getGunPosition());
-                m_currentLaser++;
-                if (m_currentLaser > m_lasers.size())
-                {
-                    m_currentLaser = 0;
-                }
-                m_lastFired = m_totalGameTime;
+                m_showOverlay = !m_showOverlay;
+                m_overlay.update(m_profiler);
             }
+#endif
         }
-    } // end input while playing
+    } // end event polling
 }
 
 /**
- * Update all object positions and check for collisions
- * Check for GameOver event (player dead)
- * @param dtSeconds time since last frame
+ * Step the World with the latest controls (or the recorded ones)
+ * Check for GameOver event (player dead, or the replay ran out)
  */
-void Engine::update(const float dtSeconds)
+void Engine::update()
 {
     // only update during the actual game
     if (state != State::Playing)
@@ -181,114 +278,124 @@ void Engine::update(const float dtSeconds)
         return;
     }
 
-    m_shroomMan.checkSpiderCollision(m_spider.getCollider());
-
-    m_player.checkSpiderCollision(m_spider.getCollider());
-
-    for (auto& laser : m_lasers)
+    // the recorded game is over
+    if (m_playback && m_tick >= m_playback->getTicks())
     {
-        // skip updating or colliding with inactive lasers
-        if (!laser.isActive())
-        {
-            continue;
-        }
-
-        if (m_spider.checkLaserCollision(laser.getCollider()))
-        {
-            laser.deactivate();
-            continue;
-        }
-
-        if (m_shroomMan.checkLaserCollision(laser.getCollider()))
-        {
-            laser.deactivate();
-            continue;
-        }
+        this->endGame();
+        return;
+    }
 
-        if (m_centipede.checkLaserCollision(laser.getCollider()))
-        {
-            laser.deactivate();
-            continue;
-        }
+    // the keyboard is ignored during playback
+    const Input controls = m_playback ? m_playback->at(m_tick) : m_controls.getInput();
 
-        laser.update(dtSeconds); // move the laser upward
+    // every key event so far is applied by this tick
+    if (m_latency && !m_playback)
+    {
+        m_latency->consume();
     }
-
-    m_centipede.update(dtSeconds);
-    m_spider.update(dtSeconds);
-    m_player.update(dtSeconds);
+    if (m_recording)
+    {
+        m_recording->record(controls);
+    }
+    m_world->step(controls);
+    m_tick++;
 
     // when the player dies, restart the game
-    if (m_player.isDead())
+    if (m_world->isOver())
     {
-        state = State::Start;
+        this->endGame();
     }
 }
 
 /** Draw all game objects to the window.
  *
- * Implements the double buffering sequence of clear-draw-display from SFML.
+ * Implements the double buffering sequence of clear-draw-display from SFML,
+ * once for the offscreen frame and once for the window.
  */
 void Engine::draw()
 {
+    {
+        // display() is left out, it can block on the driver
+        CENTIPEDE_PROFILE(&m_profiler, Phase::Draw);
 
-    m_window.clear(Engine::WorldColor);
+        m_frame.clear(Engine::WorldColor);
 
-    if (state == State::Start)
-    {
-        // draw the start screen at beginning
-        m_window.draw(m_startSprite);
+        if (state == State::Start)
+        {
+            // draw the start screen at beginning
+            m_frame.draw(m_startSprite);
+        }
+        else if (state == State::Playing)
+        {
+            // draw all the objects during game-play
+            m_renderer.draw(m_frame, *m_world);
+        }
     }
-    else if (state == State::Playing)
-    {
-        // draw all the objects during game-play
 
-        m_window.draw(m_spider);
+#ifdef CENTIPEDE_PROFILING
+    if (m_showOverlay)
+    {
+        if (m_frames % Engine::OverlayRefresh == 0)
+        {
+            m_overlay.update(m_profiler);
+        }
+        m_frame.draw(m_overlay);
+    }
+    m_frames++;
+#endif
 
-        m_window.draw(m_shroomMan);
+    m_frame.display();
 
-        // draw centipede(s)
-        m_window.draw(m_centipede);
+    m_window.clear(Engine::LetterboxColor);
+    m_window.draw(m_blit);
+    m_window.display();
 
-        // draw lasers (automatically doesn't draw inactive ones)
-        for (const auto& laser : m_lasers)
-        {
-            m_window.draw(laser);
-        }
+    // the frame with the consumed input is now on screen
+    if (m_latency)
+    {
+        m_latency->present();
+    }
+}
 
-        m_window.draw(m_player);
+#ifdef CENTIPEDE_PROFILING
+void Engine::reportTimings() const
+{
+    if (m_profiler.writeCsv(Engine::TimingsPath))
+    {
+        std::cout << "Saved frame timings to " << Engine::TimingsPath << std::endl;
     }
 
-    m_window.display();
+    for (std::size_t p = 0; p < Profiler::PhaseCount; p++)
+    {
+        const Phase      phase = static_cast<Phase>(p);
+        const PhaseStats stats = m_profiler.stats(phase);
+        std::cout << Profiler::name(phase) << ": p50 " << stats.p50 << "us, p99 " << stats.p99 << "us, max " << stats.max << "us" << std::endl;
+    }
 }
+#endif
 
 /**
- * Handles resizing the SFML viewport to preserve the correct game aspect ratio
+ * Handles rescaling the frame to preserve the correct game aspect ratio
  * when the main window is resized. This prevents any distortion of the game characters,
  * while enlarging (or shrinking) uniformly.
  *
+ * The frame is scaled by a whole number so every game pixel covers the same number of
+ * window pixels, and the rest of the window is letterboxed. A window smaller than the
+ * game shrinks the frame to fit instead.
+ *
  * @param width, height new size of the main window
  */
 void Engine::setViewport(unsigned int width, unsigned int height)
 {
-    float windowRatio = static_cast<float>(width) / static_cast<float>(height);
-    float viewRatio   = m_view.getSize().x / m_view.getSize().y;
-    float sizeX       = 1;
-    float sizeY       = 1;
-    float posX        = 0;
-    float posY        = 0;
-
-    if (windowRatio > viewRatio)
-    {
-        sizeX = viewRatio / windowRatio;
-        posX  = (1 - sizeX) / 2;
-    }
-    else
-    {
-        sizeY = windowRatio / viewRatio;
-        posY  = (1 - sizeY) / 2;
-    }
+    const auto windowX = static_cast<float>(width);
+    const auto windowY = static_cast<float>(height);
+
+    // one window unit per pixel
+    m_window.setView(sf::View{sf::FloatRect{0, 0, windowX, windowY}});
+
+    const float fit   = std::min(windowX / Game::GameSize.x, windowY / Game::GameSize.y);
+    const float scale = fit >= 1 ? std::floor(fit) : fit;
 
-    m_view.setViewport(sf::FloatRect(posX, posY, sizeX, sizeY));
-    m_window.setView(m_view);
+    m_blit.setScale(scale, scale);
+    m_blit.setPosition(std::round((windowX - Game::GameSize.x * scale) / 2), std::round((windowY - Game::GameSize.y * scale) / 2));
 }
@@ -7,24 +7,37 @@ Declare the Game Engine. Engine::run() is the main entrypoint into the game.
 */
 
 #pragma once
-#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
 
 #include "SFML/Graphics.hpp"
 
-#include "Centipede.hpp"
-#include "Laser.hpp"
-#include "Mushrooms.hpp"
-#include "Player.hpp"
-#include "Spider.hpp"
+#include "Controls.hpp"
+#include "FramePacer.hpp"
+#include "Input.hpp"
+#include "LatencyMeter.hpp"
+#include "Profiler.hpp"
+#include "Renderer.hpp"
+#include "Replay.hpp"
 #include "TextureManager.hpp"
+#include "World.hpp"
+
+#ifdef CENTIPEDE_PROFILING
+#include "ProfilerOverlay.hpp"
+#endif
 
 /**
- * The Engine is responsible for:
+ * The Engine is the SFML front end, and is responsible for:
  *  - setting up the game window,
  *  - main event loop,
  *  - getting user input,
- *  - updating game objects,
- *  - drawing to the frame
+ *  - stepping the game World,
+ *  - drawing to the frame (with the Renderer)
+ *
+ * Frames are drawn at the native resolution (WIDTHxHEIGHT) into an offscreen texture,
+ * then shown with one integer-scaled, unfiltered blit, letterboxed in the window.
  */
 class Engine
 {
@@ -34,6 +47,33 @@ class Engine
     /** Create a window and run the entire game loop */
     void run();
 
+    /** Use the same seed for every game (a random seed is picked for each game otherwise) */
+    void setSeed(std::uint32_t seed);
+
+    /**
+     * Record every game played. The replay is written to `path` when each game ends,
+     * or when the window is closed mid-game.
+     */
+    void recordTo(const std::string& path);
+
+    /** Play back a recorded game in real-time, instead of reading the keyboard */
+    void replay(Replay replay);
+
+    /** Change how ticks and frames are paced (60 ticks/s, drawn after every tick, by default) */
+    void setPacing(const FramePacer::Settings& settings);
+
+    /** @return the key bindings, to rebind the player actions */
+    Controls& getControls();
+
+    /**
+     * Measure the latency from key events to the frame that shows them, reported when the window closes.
+     * Only key events during a game played from the keyboard are measured: not the start screen, and not replays.
+     */
+    void measureLatency();
+
+    /** @return a copy of the last frame drawn, at the native resolution */
+    sf::Image capture() const;
+
     /**
      * Used to control the game loop state-machine
      */
@@ -43,10 +83,16 @@ class Engine
     /** Color for the game world background */
     static inline const sf::Color WorldColor = sf::Color::Black;
 
+    /** Color of the window around the frame */
+    static inline const sf::Color LetterboxColor = sf::Color::Black;
+
+    /** Where F12 saves the current frame */
+    static inline const std::string CapturePath = "capture.png";
+
     /** A cache for all textures used on game sprites.
      * default constructor sets up a static pointer to the only instance.
      */
-    const TextureManager texMan;
+    TextureManager texMan;
 
     /** The game RenderWindow */
     sf::RenderWindow m_window;
@@ -55,22 +101,17 @@ class Engine
      * Much smaller than the OS Window */
     sf::View m_view;
 
-    /** The player-controlled starship */
-    Player m_player;
-
-    /** Manager for all the mushrooms in the scene */
-    MushroomManager m_shroomMan;
-
-    /** All the centipedes on the screen */
-    Centipede m_centipede;
+    /** Every frame is drawn here first, one texel per game pixel */
+    sf::RenderTexture m_frame;
 
-    /** The spider antagonist moves randomly and clears mushrooms */
-    Spider m_spider;
+    /** Shows m_frame in the window, scaled and centered by setViewport() */
+    sf::Sprite m_blit;
 
-    /** A pool of 30 laser objects to recycle (should be plenty) */
-    std::array<Laser, 30> m_lasers;
+    /** All the game objects and rules, a fresh World for each game */
+    std::unique_ptr<World> m_world;
 
-    size_t m_currentLaser = 0;
+    /** Draws the World to the window */
+    Renderer m_renderer;
 
     /** Start/Game over screen sprite */
     sf::Sprite m_startSprite;
@@ -81,28 +122,72 @@ class Engine
     /** Game state machine */
     State state = State::Start;
 
-    /** Main game clock */
-    sf::Clock m_clock;
+    /** Decides when to step, when to draw, and sleeps in between */
+    FramePacer m_pacer{FramePacer::Settings{}};
 
-    /** Elapsed game time */
-    sf::Time m_totalGameTime;
+    /** Held keys and action bindings, updated from window events */
+    Controls m_controls;
 
-    /** Elapsed game time */
-    double m_elapsedTime = 0;
+    /** Fixed seed for every game, if set */
+    std::optional<std::uint32_t> m_seed;
 
-    /** Time a laser was fired */
-    sf::Time m_lastFired;
+    /** Where to save recordings (empty to not record) */
+    std::string m_recordPath;
+
+    /** Recording of the current game */
+    std::optional<Replay> m_recording;
+
+    /** Replay being played back instead of the keyboard */
+    std::optional<Replay> m_playback;
+
+    /** Ticks played in the current game */
+    std::uint64_t m_tick = 0;
+
+    /** Input latency measurement, if enabled */
+    std::optional<LatencyMeter> m_latency;
+
+#ifdef CENTIPEDE_PROFILING
+    /** Where the frame timings are written when the window closes */
+    static inline const std::string TimingsPath = "frame_timings.csv";
+
+    /** Frames between overlay refreshes (percentiles aren't cheap to find) */
+    static inline const std::uint64_t OverlayRefresh = 15;
+
+    /** Per-phase timings of recent frames */
+    Profiler m_profiler;
+
+    /** On-screen view of the timings */
+    ProfilerOverlay m_overlay;
+
+    /** True while the overlay is shown (toggled with F3) */
+    bool m_showOverlay = false;
+
+    /** Frames drawn, for pacing overlay refreshes */
+    std::uint64_t m_frames = 0;
+
+    /** Write the timings to CSV and print a summary of each phase */
+    void reportTimings() const;
+#endif
 
     /** Poll player input and hand-off to objects */
     void input();
 
-    /** Update all game objects in the scene (and detect collisions) */
-    void update(const float dtAsSeconds);
+    /**
+     * Create a fresh World and switch to playing
+     * @param seed seed of the new World
+     */
+    void startGame(std::uint32_t seed);
+
+    /** Back to the start screen, saving the recording if there is one */
+    void endGame();
+
+    /** Step the World by one tick (and detect collisions) */
+    void update();
 
-    /** Draw all objects the the frame-buffer */
+    /** Draw all objects to the offscreen frame, then show it in the window */
     void draw();
 
-    /** Resize the viewport to preserve the game aspect ratio when the window is resized
+    /** Rescale the frame to preserve the game aspect ratio when the window is resized
      * @param width, height new size of the main window
      */
     void setViewport(unsigned int width, unsigned int height);
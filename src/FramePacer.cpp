@@ -0,0 +1,156 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+FramePacer definition: fixed-step accumulator and hybrid sleep/spin waiting.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "FramePacer.hpp"
+
+namespace
+{
+
+/** Period of a rate in Hz, zero for no limit */
+FramePacer::Clock::duration periodOf(double rate)
+{
+    if (rate <= 0)
+    {
+        return FramePacer::Clock::duration::zero();
+    }
+    return std::chrono::duration_cast<FramePacer::Clock::duration>(std::chrono::duration<double>(1 / rate));
+}
+
+} // namespace
+
+FramePacer::FramePacer(Settings settings)
+    : m_settings{settings}, m_tickPeriod{periodOf(settings.simRate)}, m_framePeriod{periodOf(settings.renderRate)}
+{
+    if (m_tickPeriod == Duration::zero())
+    {
+        m_tickPeriod = periodOf(60);
+    }
+    this->reset();
+}
+
+void FramePacer::reset()
+{
+    m_last        = Clock::now();
+    m_nextFrame   = m_last;
+    m_accumulator = Duration::zero();
+}
+
+unsigned FramePacer::advance()
+{
+    const auto now = Clock::now();
+    m_accumulator += now - m_last;
+    m_last = now;
+
+    auto ticks = static_cast<std::uint64_t>(m_accumulator / m_tickPeriod);
+    m_accumulator -= m_tickPeriod * static_cast<Duration::rep>(ticks);
+
+    // too far behind, drop the backlog (the game slows down instead of stalling)
+    if (ticks > m_settings.maxCatchUp)
+    {
+        m_dropped += ticks - m_settings.maxCatchUp;
+        ticks = m_settings.maxCatchUp;
+    }
+    return static_cast<unsigned>(ticks);
+}
+
+bool FramePacer::shouldDraw(unsigned ticks)
+{
+    if (m_settings.sync == Sync::Locked)
+    {
+        return ticks > 0;
+    }
+
+    const auto now = Clock::now();
+    if (now < m_nextFrame)
+    {
+        return false;
+    }
+
+    // schedule the next frame, skipping missed ones rather than drawing them back-to-back
+    m_nextFrame += m_framePeriod;
+    if (m_nextFrame < now)
+    {
+        m_nextFrame = now + m_framePeriod;
+    }
+    return true;
+}
+
+/** The next deadline is whichever comes first, the next tick or the next frame */
+void FramePacer::wait()
+{
+    Clock::time_point deadline = m_last + (m_tickPeriod - m_accumulator);
+    if (m_settings.sync == Sync::Independent)
+    {
+        // an unlimited frame rate never waits
+        if (m_framePeriod == Duration::zero())
+        {
+            return;
+        }
+        deadline = std::min(deadline, m_nextFrame);
+    }
+    this->waitUntil(deadline);
+}
+
+/**
+ * Sleep in short slices while the deadline is further away than a sleep usually takes,
+ * then spin (yielding) for the rest.
+ */
+void FramePacer::waitUntil(Clock::time_point deadline)
+{
+    auto now = Clock::now();
+    while (now < deadline)
+    {
+        const double stddev   = std::sqrt(m_sleepM2 / static_cast<double>(m_sleepCount));
+        const double estimate = m_sleepMean + stddev;
+        const double left     = std::chrono::duration<double>(deadline - now).count();
+        if (left <= estimate)
+        {
+            break;
+        }
+
+        std::this_thread::sleep_for(FramePacer::SleepSlice);
+        const auto woke = Clock::now();
+        this->recordSleep(std::chrono::duration<double>(woke - now).count());
+        now = woke;
+    }
+
+    const auto spinUntil = std::min(deadline, now + FramePacer::MaxSpin);
+    while (Clock::now() < spinUntil)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::recordSleep(double seconds)
+{
+    // forget old history slowly, so the estimate follows changes in system load
+    if (m_sleepCount >= 1000)
+    {
+        m_sleepCount = 500;
+        m_sleepM2 /= 2;
+    }
+
+    m_sleepCount++;
+    const double delta = seconds - m_sleepMean;
+    m_sleepMean += delta / static_cast<double>(m_sleepCount);
+    m_sleepM2 += delta * (seconds - m_sleepMean);
+}
+
+const FramePacer::Settings& FramePacer::getSettings() const
+{
+    return m_settings;
+}
+
+std::uint64_t FramePacer::getDroppedTicks() const
+{
+    return m_dropped;
+}
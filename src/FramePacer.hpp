@@ -0,0 +1,118 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Declare the FramePacer, which decides when the game loop steps the simulation,
+when it draws, and how long it sleeps in between.
+*/
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Paces the game loop with a fixed-step accumulator.
+ *
+ * Real time is added to an accumulator, and one tick is stepped for every tick
+ * period it holds. Leftover time carries into the next frame, so the game runs at
+ * the right speed however the frames line up. If the game falls too far behind
+ * (a slow machine, a dragged window) only MaxCatchUp ticks are stepped and the
+ * rest is dropped, instead of spiralling into ever longer catch-up frames.
+ *
+ * Between frames the loop sleeps until shortly before the next deadline, then spins
+ * for the last part. How long to spin is learned from how late sleeps wake up.
+ */
+class FramePacer
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** How drawing relates to simulation ticks */
+    enum class Sync {
+        Locked,     // draw once after every batch of ticks (render rate = simulation rate)
+        Independent // draw at renderRate, whether or not a tick was stepped
+    };
+
+    struct Settings
+    {
+        /** Ticks per second of real time (60 is normal speed, every tick is always Game::Tick of game time) */
+        double simRate = 60;
+
+        /** How drawing relates to ticks */
+        Sync sync = Sync::Locked;
+
+        /** Frames per second for Sync::Independent (0 draws as fast as possible) */
+        double renderRate = 60;
+
+        /** Most ticks stepped in one frame, the rest of a backlog is dropped */
+        unsigned maxCatchUp = 5;
+    };
+
+    /** Construct a new FramePacer */
+    explicit FramePacer(Settings settings);
+
+    /** Start timing from now, forgetting any backlog (e.g. after loading) */
+    void reset();
+
+    /**
+     * Add the real time since the last call to the accumulator
+     * @return number of ticks to step now (at most Settings::maxCatchUp)
+     */
+    unsigned advance();
+
+    /**
+     * Check if a frame should be drawn now
+     * @param ticks the number of ticks just stepped (from advance())
+     */
+    bool shouldDraw(unsigned ticks);
+
+    /** Block until the next tick or frame is due (sleep, then spin) */
+    void wait();
+
+    /** @return the settings in use */
+    const Settings& getSettings() const;
+
+    /** @return ticks dropped because the game fell behind */
+    std::uint64_t getDroppedTicks() const;
+
+  private:
+    using Duration = Clock::duration;
+
+    /** Length of each sleep (shorter sleeps wake up more accurately) */
+    static constexpr std::chrono::microseconds SleepSlice{1000};
+
+    /** Longest spin, in case the oversleep estimate goes wild */
+    static constexpr std::chrono::microseconds MaxSpin{4000};
+
+    /** Sleep (and spin) until `deadline` */
+    void waitUntil(Clock::time_point deadline);
+
+    /** Learn how late a sleep of SleepSlice wakes up (seconds) */
+    void recordSleep(double seconds);
+
+    Settings m_settings;
+
+    /** Real time per tick */
+    Duration m_tickPeriod;
+
+    /** Real time per frame (Sync::Independent), zero for no limit */
+    Duration m_framePeriod;
+
+    /** Real time not yet stepped */
+    Duration m_accumulator{0};
+
+    /** Time of the last advance() */
+    Clock::time_point m_last;
+
+    /** When the next frame is due (Sync::Independent) */
+    Clock::time_point m_nextFrame;
+
+    /** Ticks dropped by the catch-up limit */
+    std::uint64_t m_dropped = 0;
+
+    // running mean and variance of sleep durations (Welford's method), used to decide when to stop sleeping
+    double        m_sleepMean  = 0.002;
+    double        m_sleepM2    = 0;
+    std::uint64_t m_sleepCount = 1;
+};
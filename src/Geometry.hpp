@@ -0,0 +1,90 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Plain geometry types used by the game simulation.
+These mirror sf::Vector2f and sf::FloatRect, so the simulation can be built without SFML.
+*/
+
+#pragma once
+
+/** A 2D vector of floats (position, size, displacement) */
+struct Vec2f
+{
+    float x = 0;
+    float y = 0;
+};
+
+constexpr Vec2f operator+(Vec2f a, Vec2f b) noexcept
+{
+    return {a.x + b.x, a.y + b.y};
+}
+
+constexpr Vec2f operator-(Vec2f a, Vec2f b) noexcept
+{
+    return {a.x - b.x, a.y - b.y};
+}
+
+constexpr Vec2f operator*(Vec2f v, float s) noexcept
+{
+    return {v.x * s, v.y * s};
+}
+
+constexpr Vec2f operator/(Vec2f v, float s) noexcept
+{
+    return {v.x / s, v.y / s};
+}
+
+constexpr Vec2f& operator+=(Vec2f& a, Vec2f b) noexcept
+{
+    a.x += b.x;
+    a.y += b.y;
+    return a;
+}
+
+constexpr bool operator==(Vec2f a, Vec2f b) noexcept
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+constexpr bool operator!=(Vec2f a, Vec2f b) noexcept
+{
+    return !(a == b);
+}
+
+/** An axis-aligned rectangle, defined by the top-left corner and size */
+struct FloatRect
+{
+    float left   = 0;
+    float top    = 0;
+    float width  = 0;
+    float height = 0;
+
+    /** @return the size of the rectangle as a vector */
+    constexpr Vec2f getSize() const noexcept
+    {
+        return {width, height};
+    }
+
+    /**
+     * Check if two rectangles overlap.
+     * Touching edges do not count as overlapping (same as sf::Rect::intersects)
+     * @param other rectangle to test against
+     * @return true if the rectangles share some area
+     */
+    constexpr bool intersects(const FloatRect& other) const noexcept
+    {
+        return left < other.left + other.width && other.left < left + width && //
+               top < other.top + other.height && other.top < top + height;
+    }
+};
+
+/**
+ * Build a rectangle of `size` centered on `center`.
+ * All the game objects use a centered origin.
+ */
+constexpr FloatRect centeredRect(Vec2f center, Vec2f size) noexcept
+{
+    return {center.x - size.x / 2.f, center.y - size.y / 2.f, size.x, size.y};
+}
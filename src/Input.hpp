@@ -0,0 +1,33 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Player controls for a single tick of the game.
+Normally filled from the keyboard, or from a script when running headless.
+*/
+
+#pragma once
+#include <cstdint>
+#include <functional>
+
+/** The state of every player control during one tick */
+struct Input
+{
+    /** Up movement is held */
+    bool up = false;
+    /** Down movement is held */
+    bool down = false;
+    /** Left movement is held */
+    bool left = false;
+    /** Right movement is held */
+    bool right = false;
+    /** Fire button is held */
+    bool fire = false;
+};
+
+/**
+ * Scripted input source for headless games.
+ * Called once per simulated tick with the tick number (starting at 0).
+ */
+using InputScript = std::function<Input(std::uint64_t tick)>;
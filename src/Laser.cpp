@@ -11,18 +11,15 @@ but the requirements for this assignment specifically asked for multiple.
 
 TODO: I will probably change how this works after submitting.
 */
-#include "SFML/Graphics.hpp"
-
 #include "Laser.hpp"
+#include "Settings.hpp"
 
 /**
  * Construct a new Laser object.
- * Set the size and color, and set origin to center.
+ * Starts inactive, the position is set when shot.
  */
-Laser::Laser() : m_shape{Laser::Size}
+Laser::Laser()
 {
-    m_shape.setFillColor(Laser::Color);
-    m_shape.setOrigin(Laser::Size.x / 2.f, Laser::Size.y / 2.f);
 }
 
 /** Update sprite position based on elapsed seconds. */
@@ -37,24 +34,15 @@ void Laser::update(float deltaTime)
     // distance traveled (up)
     const float distance = -Laser::Speed * deltaTime;
 
-    m_shape.move(0, distance);
+    this->moveTo({m_position.x, m_position.y + distance});
 
     // deactivate when hitting the top of the screen
-    if (m_shape.getPosition().y < 0)
+    if (m_position.y < 0)
     {
         m_active = false;
     }
 }
 
-/** Only draw an active laser to the scene */
-void Laser::draw(sf::RenderTarget& target, sf::RenderStates states) const
-{
-    if (m_active)
-    {
-        target.draw(m_shape, states);
-    }
-}
-
 /**
  * Make this Laser active, and set it's position to (x,y)
  * @param x pos of start
@@ -64,7 +52,7 @@ void Laser::shoot(float x, float y)
 {
     m_active = true;
 
-    m_shape.setPosition(x, y);
+    this->moveTo({x, y});
 }
 
 /**
@@ -72,15 +60,20 @@ void Laser::shoot(float x, float y)
  * Overload for vector start position
  * @param start  position to start from
  */
-void Laser::shoot(sf::Vector2f start)
+void Laser::shoot(Vec2f start)
 {
     shoot(start.x, start.y);
 }
 
 /** Return the boundary collider of this laser object. */
-sf::FloatRect Laser::getCollider() const
+const FloatRect& Laser::getCollider() const
 {
-    return m_shape.getGlobalBounds();
+    return m_collider;
+}
+
+Vec2f Laser::getPosition() const
+{
+    return m_position;
 }
 
 bool Laser::isActive() const
@@ -92,3 +85,26 @@ void Laser::deactivate()
 {
     m_active = false;
 }
+
+void Laser::save(ByteWriter& out) const
+{
+    out.flag(m_active);
+    out.vec(m_position);
+}
+
+/**
+ * Lasers are shot inside the game area, and deactivated within one step of leaving its top
+ * (an unused laser is still at the origin).
+ */
+void Laser::restore(ByteReader& in)
+{
+    const float step = Laser::Speed * Game::Tick;
+    m_active         = in.flag();
+    this->moveTo(in.vecWithin({0, -step, Game::GameSize.x, Game::GameSize.y + step}));
+}
+
+void Laser::moveTo(Vec2f position)
+{
+    m_position = position;
+    m_collider = centeredRect(m_position, Laser::Size);
+}
@@ -9,18 +9,22 @@ I might go that route, it would simplify the fire-rate timing.
 */
 
 #pragma once
-#include <SFML/Graphics.hpp>
+#include "Geometry.hpp"
+#include "Serialize.hpp"
 
 /**
  * Laser objects that can be recycled throughout the scene.
  * Instances that are not `Laser::active` should not be drawn or updated.
  */
-class Laser : public sf::Drawable
+class Laser
 {
   public:
     /** Fire-rate of all Laser instances (shots/second) */
     static constexpr double FireRate = 6.5;
 
+    /** Size of all lasers (px) */
+    static constexpr Vec2f Size{1.0, 6.0};
+
     /** Construct a new Laser. */
     Laser();
 
@@ -32,12 +36,6 @@ class Laser : public sf::Drawable
      */
     void update(float deltaTime);
 
-    /**
-     * Draw to the target
-     * Implements sf::Drawable.draw
-     */
-    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
-
     /**
      * Make this Laser active, and set it's position to (x,y)
      * @param x pos of start
@@ -49,15 +47,18 @@ class Laser : public sf::Drawable
      * Make this Laser active, and set it's position to `start`
      * @param start vector position to start from
      */
-    void shoot(sf::Vector2f);
+    void shoot(Vec2f);
 
     /**
      * Get the boundary collider for this laser.
      * For use with collision detection
      *
-     * @return sf::FloatRect global bounds rectangle of the laser
+     * @return FloatRect global bounds rectangle of the laser (kept up to date as the laser moves)
      */
-    sf::FloatRect getCollider() const;
+    const FloatRect& getCollider() const;
+
+    /** @return the center of the laser */
+    Vec2f getPosition() const;
 
     /** Change the state of this laser to in-active */
     void deactivate();
@@ -65,21 +66,27 @@ class Laser : public sf::Drawable
     /** @return if this laser is currently active */
     bool isActive() const;
 
+    /** Write the active flag and position to a snapshot */
+    void save(ByteWriter& out) const;
+
+    /** Read back the state written by save() */
+    void restore(ByteReader& in);
+
   private:
     // Static properties common to all lasers
 
     /** Laser speed in px/second. Original game had 7px per frame (60fps). */
     static constexpr float Speed = 7 * 60;
 
-    /** Color of all lasers (Red) */
-    static inline const sf::Color Color = sf::Color::Red;
-
-    /** Size of all lasers (px) */
-    static inline const sf::Vector2f Size{1.0, 6.0};
-
     /** Only draw active lasers. */
     bool m_active = false;
 
-    /** Shape of the laser (rectangle) */
-    sf::RectangleShape m_shape;
+    /** Center of the laser */
+    Vec2f m_position;
+
+    /** Bounding box around m_position */
+    FloatRect m_collider = centeredRect(m_position, Laser::Size);
+
+    /** Set the position, and the collider around it */
+    void moveTo(Vec2f position);
 };
@@ -0,0 +1,93 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Latency measurement definitions.
+*/
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+#include "LatencyMeter.hpp"
+
+namespace
+{
+
+/** Milliseconds between two stamps */
+float millis(LatencyMeter::Clock::time_point from, LatencyMeter::Clock::time_point to)
+{
+    return std::chrono::duration<float, std::milli>(to - from).count();
+}
+
+} // namespace
+
+void LatencyMeter::observe()
+{
+    m_pending.push_back(Clock::now());
+}
+
+void LatencyMeter::consume()
+{
+    const auto now = Clock::now();
+    for (const auto& observed : m_pending)
+    {
+        m_consumed.push_back({observed, now});
+    }
+    m_pending.clear();
+}
+
+void LatencyMeter::present()
+{
+    const auto now = Clock::now();
+    for (const auto& event : m_consumed)
+    {
+        m_toUpdate.push_back(millis(event.observed, event.consumed));
+        m_toDisplay.push_back(millis(event.observed, now));
+    }
+    m_consumed.clear();
+}
+
+void LatencyMeter::report(std::ostream& out) const
+{
+    out << "Input latency over " << m_toDisplay.size() << " events" << std::endl;
+    if (m_toDisplay.empty())
+    {
+        return;
+    }
+    LatencyMeter::report(out, "to update", m_toUpdate);
+    LatencyMeter::report(out, "to display", m_toDisplay);
+}
+
+void LatencyMeter::report(std::ostream& out, const char* name, std::vector<float> samples)
+{
+    auto percentile = [&](std::size_t percent) {
+        const std::size_t rank = (samples.size() - 1) * percent / 100;
+        std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+        return samples[rank];
+    };
+
+    out << "  " << name << ": p50 " << percentile(50) << "ms, p90 " << percentile(90) << "ms, p99 " << percentile(99)
+        << "ms, max " << *std::max_element(samples.begin(), samples.end()) << "ms" << std::endl;
+
+    std::array<std::size_t, LatencyMeter::Buckets> counts{};
+    for (float sample : samples)
+    {
+        const auto bucket = static_cast<std::size_t>(std::max(sample, 0.f) / LatencyMeter::BucketWidth);
+        counts[std::min(bucket, LatencyMeter::Buckets - 1)]++;
+    }
+
+    // one '#' per 2% of the events
+    for (std::size_t i = 0; i < counts.size(); i++)
+    {
+        if (counts[i] == 0)
+        {
+            continue;
+        }
+        const auto low  = static_cast<int>(static_cast<float>(i) * LatencyMeter::BucketWidth);
+        const auto high = static_cast<int>(static_cast<float>(i + 1) * LatencyMeter::BucketWidth);
+        const std::string range = i + 1 < counts.size() ? std::to_string(low) + "-" + std::to_string(high) : std::to_string(low) + "+";
+        out << "    " << range << "ms\t" << counts[i] << "\t" << std::string(counts[i] * 50 / samples.size(), '#') << std::endl;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Input-to-photon latency measurement (centipede --latency).
+*/
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+/**
+ * Follows input events from the moment they are polled to the frame that shows them.
+ *
+ * Every event is stamped with a monotonic time when it is observed. The stamps are
+ * handed to the next simulation tick, and finished when that tick's frame returns
+ * from display(). With vsync off, display() returning is the closest the game can
+ * get to the photons leaving the screen.
+ *
+ * Two distributions are kept: time until the simulation read the input, and the
+ * full time until it was displayed.
+ */
+class LatencyMeter
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** An input event was just polled */
+    void observe();
+
+    /** The simulation just read the input (every event observed so far) */
+    void consume();
+
+    /** The frame of the consumed input was just displayed */
+    void present();
+
+    /** Print the number of events, percentiles and a histogram of both distributions */
+    void report(std::ostream& out) const;
+
+  private:
+    /** Width of each histogram bucket (ms) */
+    static constexpr float BucketWidth = 2;
+
+    /** Number of histogram buckets (the last one holds everything slower) */
+    static constexpr std::size_t Buckets = 17;
+
+    /** An event the simulation has read, waiting for its frame */
+    struct Consumed
+    {
+        Clock::time_point observed;
+        Clock::time_point consumed;
+    };
+
+    /**
+     * Print one distribution
+     * @param name label of the distribution
+     * @param samples latencies (ms), copied because finding percentiles reorders them
+     */
+    static void report(std::ostream& out, const char* name, std::vector<float> samples);
+
+    /** Events observed, not yet read by the simulation */
+    std::vector<Clock::time_point> m_pending;
+
+    /** Events read by the simulation, not yet displayed */
+    std::vector<Consumed> m_consumed;
+
+    /** Latency from observing an event to the simulation reading it (ms) */
+    std::vector<float> m_toUpdate;
+
+    /** Latency from observing an event to displaying its frame (ms) */
+    std::vector<float> m_toDisplay;
+};
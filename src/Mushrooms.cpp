@@ -7,30 +7,22 @@ The MushroomManager and Shroom class definition.
 */
 
 #include <algorithm>
-#include <list>
-#include <random>
-
-#include "SFML/Graphics.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include "Mushrooms.hpp"
 #include "Settings.hpp"
-#include "TextureManager.hpp"
-
-/** Base constructor from x,y coordinates */
-Shroom::Shroom(float x, float y)
-{
 
-    const auto& tex = TextureManager::GetTexture("graphics/sprites.png");
-    this->setTexture(tex);
-    this->setTextureRect(FullTexOffset);
+static_assert(sizeof(Shroom) == 8, "mushrooms are packed in 8 bytes");
 
-    const auto& size = this->getLocalBounds().getSize();
-    this->setOrigin(size.x / 2.f, size.y / 2.f);
-    this->setPosition(x, y);
-}
-
-/** Constructor overload for Vector parameter*/
-Shroom::Shroom(sf::Vector2f location) : Shroom{location.x, location.y}
+/** Base constructor from the cell (the slot and health share a word) */
+Shroom::Shroom(int column, int row, std::uint32_t slot)
+    : m_column{static_cast<std::int16_t>(column)}, m_row{static_cast<std::int16_t>(row)}, m_slot{slot & Shroom::MaxSlot}, m_health{Shroom::MaxHealth}
 {
 }
 
@@ -41,106 +33,187 @@ Shroom::Shroom(sf::Vector2f location) : Shroom{location.x, location.y}
  */
 int Shroom::damage()
 {
-    if (m_health <= 0)
+    if (m_health == 0)
     {
         return 0;
     }
 
-    m_health -= 1;
+    m_health = (m_health - 1) & 0xFu;
+
+    return static_cast<int>(m_health);
+}
+
+int Shroom::getHealth() const
+{
+    return static_cast<int>(m_health);
+}
+
+int Shroom::getColumn() const
+{
+    return m_column;
+}
+
+int Shroom::getRow() const
+{
+    return m_row;
+}
+
+/** The center of the cell */
+Vec2f Shroom::getPosition() const
+{
+    return {static_cast<float>(m_column * Game::GridSize) + Game::GridSize / 2.f, static_cast<float>(m_row * Game::GridSize) + Game::GridSize / 2.f};
+}
+
+std::uint32_t Shroom::getSlot() const
+{
+    return m_slot;
+}
+
+FloatRect Shroom::getCollider() const
+{
+    return centeredRect(this->getPosition(), Shroom::Size);
+}
+
+/** The position is saved rather than the cell, so the format doesn't depend on the grid size */
+void Shroom::save(ByteWriter& out) const
+{
+    out.vec(this->getPosition());
+    out.byte(static_cast<std::uint8_t>(m_health));
+}
+
+/**
+ * Only living mushrooms are kept, so health must be 1 to MaxHealth.
+ * NaN fails every comparison, so non-finite positions are rejected before the range check.
+ */
+void Shroom::restore(ByteReader& in)
+{
+    const Vec2f position = in.vec();
+    if (!std::isfinite(position.x) || !std::isfinite(position.y))
+    {
+        in.fail("Invalid mushroom position in");
+    }
+    const float column = std::floor(position.x / Game::GridSize);
+    const float row    = std::floor(position.y / Game::GridSize);
+    if (column < Shroom::MinCell || column > Shroom::MaxCell || row < Shroom::MinCell || row > Shroom::MaxCell)
+    {
+        in.fail("Mushroom out of range in");
+    }
+    m_column = static_cast<std::int16_t>(column);
+    m_row    = static_cast<std::int16_t>(row);
+    if (this->getPosition() != position)
+    {
+        in.fail("Mushroom off the grid in");
+    }
 
-    // Step through the textures for different damage levels,
-    switch (m_health)
+    m_health = static_cast<std::uint32_t>(in.byteBelow(Shroom::MaxHealth + 1)) & 0xFu;
+    if (m_health == 0)
     {
-    case 3:
-        this->setTextureRect(Damage3TexOffset);
-        break;
-    case 2:
-        this->setTextureRect(Damage2TexOffset);
-        break;
-    case 1:
-        this->setTextureRect(Damage1TexOffset);
-        break;
-    case 0:
-        // nothing to do, dead now. will get removed by manager
-        break;
-    default:
-        throw std::runtime_error("Exhuastive switch failure: shroom.m_health");
-        break;
+        in.fail("Invalid mushroom health in");
     }
+}
+
+static_assert(Shroom::MaxHealth <= 4, "health is stored in two bit planes");
+
+void ShroomField::reset(int columns, int rows)
+{
+    m_columns  = columns;
+    m_rows     = rows;
+    m_rowWords = (columns + ShroomField::WordBits - 1) / ShroomField::WordBits;
+    m_bits.assign(ShroomField::PlaneCount * static_cast<std::size_t>(m_rows) * static_cast<std::size_t>(m_rowWords), 0);
+}
+
+bool ShroomField::has(int column, int row) const
+{
+    return (this->occupiedFrom(column, row) & 1u) != 0;
+}
+
+void ShroomField::setHealth(int column, int row, int health)
+{
+    const std::uint32_t bit   = std::uint32_t{1} << (column % ShroomField::WordBits);
+    const auto          level = static_cast<std::uint32_t>(std::max(health - 1, 0));
 
-    return m_health;
+    const auto put = [&](Plane plane, bool on) {
+        std::uint32_t& word = m_bits[this->wordOf(plane, column, row)];
+        word                = on ? (word | bit) : (word & ~bit);
+    };
+    put(Occupied, health > 0);
+    put(HealthLow, health > 0 && (level & 1u) != 0);
+    put(HealthHigh, health > 0 && (level & 2u) != 0);
 }
 
-sf::Vector2f Shroom::getRightEdge() const
+std::uint32_t ShroomField::occupiedFrom(int column, int row) const
 {
-    const sf::FloatRect& size   = this->getLocalBounds();
-    const sf::Vector2f&  center = this->getPosition();
-    return sf::Vector2f(center.x + size.width / 2.f, center.y);
+    return m_bits[this->wordOf(Occupied, column, row)] >> (column % ShroomField::WordBits);
 }
 
-sf::Vector2f Shroom::getLeftEdge() const
+int ShroomField::getColumns() const
 {
-    const sf::FloatRect& size   = this->getLocalBounds();
-    const sf::Vector2f&  center = this->getPosition();
-    return sf::Vector2f(center.x - size.width / 2.f, center.y);
+    return m_columns;
+}
+
+int ShroomField::getRows() const
+{
+    return m_rows;
+}
+
+int ShroomField::getRowWords() const
+{
+    return m_rowWords;
+}
+
+std::size_t ShroomField::wordOf(Plane plane, int column, int row) const
+{
+    const std::size_t line = plane * static_cast<std::size_t>(m_rows) + static_cast<std::size_t>(row);
+    return line * static_cast<std::size_t>(m_rowWords) + static_cast<std::size_t>(column / ShroomField::WordBits);
 }
 
 /**
  * Manager constructor initializes the members and
- * creates 30 mushroom sprites randomly scattered in the given bounds.
+ * creates `count` mushrooms (30 in a game) randomly scattered in the given bounds.
+ * A cell that is already taken is drawn again, until the count (or every cell) is filled.
  *
- * The random number generate needs to be initalized with a true random device, or a seed value.
+ * The random number generator is seeded by the World, so a game can be reproduced.
  *
  * @param bounds Rectangle where mushrooms should be placed
+ * @param seed random seed for placement
+ * @param count number of mushrooms to place
  */
-MushroomManager::MushroomManager(sf::FloatRect bounds) : m_bounds(bounds), m_rng(std::random_device{}())
+MushroomManager::MushroomManager(FloatRect bounds, std::uint32_t seed, std::size_t count) : m_bounds(bounds), m_rng(seed)
 {
     // Need a random distribution aligned in the 30x30 grid
-    auto                               x_range = static_cast<int>(m_bounds.width / Game::GridSize) - 1;
-    auto                               y_range = static_cast<int>(m_bounds.height / Game::GridSize) - 1;
-    std::uniform_int_distribution<int> random_x(0, x_range);
-    std::uniform_int_distribution<int> random_y(0, y_range);
+    const auto x_range = static_cast<std::uint32_t>(m_bounds.width / Game::GridSize);
+    const auto y_range = static_cast<std::uint32_t>(m_bounds.height / Game::GridSize);
 
-    // Create 30 mushroom sprites in random locations
-    for (size_t i = 0; i < 30; ++i)
+    this->reserve(m_bounds);
+
+    // Create the mushrooms in random locations
+    const std::size_t target = std::min<std::size_t>(count, static_cast<std::size_t>(x_range) * y_range);
+    while (m_shrooms.size() < target)
     {
         // random grid cells need to be offset so they refer to the center
-        const float gridx = static_cast<float>(Game::GridSize * random_x(m_rng));
-        const float gridy = static_cast<float>(Game::GridSize * random_y(m_rng));
+        const float gridx = static_cast<float>(Game::GridSize) * static_cast<float>(Game::randomBelow(m_rng, x_range));
+        const float gridy = static_cast<float>(Game::GridSize) * static_cast<float>(Game::randomBelow(m_rng, y_range));
         const float xPos  = m_bounds.left + gridx + Game::GridSize / 2.f;
         const float yPos  = m_bounds.top + gridy + Game::GridSize / 2.f;
-        // Create and add to list in-place
-        m_shrooms.emplace_back(xPos, yPos);
+        // Create and add in-place
+        this->place({xPos, yPos});
     }
 }
 
 /** Constant reference getter prevents modification */
-const std::list<Shroom>& MushroomManager::getShrooms() const
+const std::vector<Shroom>& MushroomManager::getShrooms() const
 {
     return m_shrooms;
 }
 
-/** Implement virtual method from Drawable so MushroomManager can be drawn by the Engine */
-void MushroomManager::draw(sf::RenderTarget& target, sf::RenderStates states) const
-{
-    // only draw currently active mushrooms
-    for (const auto& shroom : m_shrooms)
-    {
-        target.draw(shroom, states);
-    }
-}
-
 /** Remove any mushrooms that the spider intersects with */
-bool MushroomManager::checkSpiderCollision(sf::FloatRect spider)
+bool MushroomManager::checkSpiderCollision(FloatRect spider)
 {
-    // construct lambda predicate
-    auto isHit = [&](const Shroom& s) { return spider.intersects(s.getGlobalBounds()); };
-    // find first intersecting mushroom
-    auto hit_it = std::find_if(m_shrooms.begin(), m_shrooms.end(), isHit);
-    // remove if found
-    if (hit_it != m_shrooms.end())
+    // find an intersecting mushroom, and remove it
+    const std::uint32_t hit = this->findHit(spider);
+    if (hit != MushroomManager::NoShroom)
     {
-        m_shrooms.erase(hit_it);
+        this->remove(hit);
         return true;
     }
     return false;
@@ -149,23 +222,28 @@ bool MushroomManager::checkSpiderCollision(sf::FloatRect spider)
 /** Damage any mushroom hit by a laser beam.
  * @return true if a mushroom was hit
  */
-bool MushroomManager::checkLaserCollision(sf::FloatRect laser)
+bool MushroomManager::checkLaserCollision(FloatRect laser)
 {
-    // construct lambda predicate
-    auto isHit = [&](const Shroom& s) { return laser.intersects(s.getGlobalBounds()); };
-
-    // find the first intersecting mushroom (probably only 1 or none)
-    auto hit_it = std::find_if(m_shrooms.begin(), m_shrooms.end(), isHit);
+    // find the intersecting mushroom (probably only 1 or none)
+    const std::uint32_t hit = this->findHit(laser);
 
     // found one
-    if (hit_it != m_shrooms.end())
+    if (hit != MushroomManager::NoShroom)
     {
-        // Damage the mushroom to change it's texture,
-        int remaining_health = hit_it->damage();
+        // Damage the mushroom (changes it's texture),
+        int remaining_health = m_shrooms[hit].damage();
         // and delete if it was destroyed
         if (remaining_health <= 0)
         {
-            m_shrooms.erase(hit_it);
+            this->remove(hit);
+        }
+        else
+        {
+            this->setField(m_shrooms[hit]);
+            if (m_listener != nullptr)
+            {
+                m_listener->shroomChanged(m_shrooms[hit]);
+            }
         }
         return true;
     }
@@ -173,10 +251,289 @@ bool MushroomManager::checkLaserCollision(sf::FloatRect laser)
     return false;
 }
 
-/** Adds a mushroom the list list at a specific location.
+/** Adds a mushroom at a specific location.
  * Used by centipede class with split.
  */
-void MushroomManager::addMushroom(sf::Vector2f location)
+void MushroomManager::addMushroom(Vec2f location)
+{
+    this->place(location);
+}
+
+void MushroomManager::reserve(FloatRect area)
+{
+    this->growGrid(MushroomManager::cellOf({area.left, area.top}), MushroomManager::cellOf({area.left + area.width - 1, area.top + area.height - 1}));
+}
+
+bool MushroomManager::hasShroom(int column, int row) const
+{
+    const int x = column - m_gridOrigin.x;
+    const int y = row - m_gridOrigin.y;
+    return x >= 0 && y >= 0 && x < m_gridColumns && y < m_gridRows && m_field.has(x, y);
+}
+
+const ShroomField& MushroomManager::getField() const
+{
+    return m_field;
+}
+
+FloatRect MushroomManager::getFieldArea() const
+{
+    return {static_cast<float>(m_gridOrigin.x * Game::GridSize), static_cast<float>(m_gridOrigin.y * Game::GridSize),
+            static_cast<float>(m_gridColumns * Game::GridSize), static_cast<float>(m_gridRows * Game::GridSize)};
+}
+
+FloatRect MushroomManager::getBounds() const
+{
+    return m_bounds;
+}
+
+std::uint32_t MushroomManager::getSlotCount() const
+{
+    return m_slotCount;
+}
+
+void MushroomManager::setListener(MushroomListener* listener)
+{
+    m_listener = listener;
+    if (m_listener != nullptr)
+    {
+        m_listener->shroomsReset(*this);
+    }
+}
+
+void MushroomManager::swap(MushroomManager& other)
+{
+    std::swap(*this, other);
+    std::swap(m_listener, other.m_listener);
+    for (MushroomManager* manager : {this, &other})
+    {
+        if (manager->m_listener != nullptr)
+        {
+            manager->m_listener->shroomsReset(*manager);
+        }
+    }
+}
+
+MushroomManager::Cell MushroomManager::cellOf(Vec2f point)
+{
+    return {static_cast<int>(std::floor(point.x / Game::GridSize)), static_cast<int>(std::floor(point.y / Game::GridSize))};
+}
+
+std::uint32_t* MushroomManager::gridAt(Cell cell)
+{
+    const int x = cell.x - m_gridOrigin.x;
+    const int y = cell.y - m_gridOrigin.y;
+    if (x < 0 || y < 0 || x >= m_gridColumns || y >= m_gridRows)
+    {
+        return nullptr;
+    }
+    return &m_grid[static_cast<std::size_t>(y) * static_cast<std::size_t>(m_gridColumns) + static_cast<std::size_t>(x)];
+}
+
+const std::uint32_t* MushroomManager::gridAt(Cell cell) const
+{
+    return const_cast<MushroomManager*>(this)->gridAt(cell);
+}
+
+/**
+ * Only a mushroom placed outside the grid (and the reserved areas) grows it.
+ * It is the only time a game allocates after the start.
+ */
+void MushroomManager::growGrid(Cell first, Cell last)
+{
+    if (this->gridAt(first) != nullptr && this->gridAt(last) != nullptr)
+    {
+        return;
+    }
+    if (m_gridColumns > 0 && m_gridRows > 0)
+    {
+        first = {std::min(first.x, m_gridOrigin.x), std::min(first.y, m_gridOrigin.y)};
+        last  = {std::max(last.x, m_gridOrigin.x + m_gridColumns - 1), std::max(last.y, m_gridOrigin.y + m_gridRows - 1)};
+    }
+
+    std::vector<std::uint32_t> grid;
+    std::swap(grid, m_grid);
+    const Cell oldOrigin  = m_gridOrigin;
+    const int  oldColumns = m_gridColumns;
+
+    m_gridOrigin  = first;
+    m_gridColumns = last.x - first.x + 1;
+    m_gridRows    = last.y - first.y + 1;
+    m_grid.assign(static_cast<std::size_t>(m_gridColumns) * static_cast<std::size_t>(m_gridRows), MushroomManager::NoShroom);
+
+    // at most one mushroom (and so one slot) per cell, so placing and removing never allocates
+    m_shrooms.reserve(m_grid.size());
+    m_freeSlots.reserve(m_grid.size());
+
+    for (std::size_t i = 0; i < grid.size(); i++)
+    {
+        if (grid[i] != MushroomManager::NoShroom)
+        {
+            const int x = static_cast<int>(i % static_cast<std::size_t>(oldColumns));
+            const int y = static_cast<int>(i / static_cast<std::size_t>(oldColumns));
+            *this->gridAt({oldOrigin.x + x, oldOrigin.y + y}) = grid[i];
+        }
+    }
+
+    m_field.reset(m_gridColumns, m_gridRows);
+    for (const Shroom& shroom : m_shrooms)
+    {
+        this->setField(shroom);
+    }
+}
+
+void MushroomManager::setField(const Shroom& shroom, bool removed)
+{
+    m_field.setHealth(shroom.getColumn() - m_gridOrigin.x, shroom.getRow() - m_gridOrigin.y, removed ? 0 : shroom.getHealth());
+}
+
+/**
+ * Touching edges don't overlap, so a collider only covers the cells its area is in.
+ * Each row is scanned a word of occupancy bits at a time, so empty stretches are skipped.
+ */
+std::uint32_t MushroomManager::findHit(FloatRect collider) const
 {
-    m_shrooms.emplace_back(location);
+    // the overlapped cells, clipped to the grid
+    const int firstX = std::max(static_cast<int>(std::floor(collider.left / Game::GridSize)) - m_gridOrigin.x, 0);
+    const int firstY = std::max(static_cast<int>(std::floor(collider.top / Game::GridSize)) - m_gridOrigin.y, 0);
+    const int lastX  = std::min(static_cast<int>(std::ceil((collider.left + collider.width) / Game::GridSize)) - 1 - m_gridOrigin.x, m_gridColumns - 1);
+    const int lastY  = std::min(static_cast<int>(std::ceil((collider.top + collider.height) / Game::GridSize)) - 1 - m_gridOrigin.y, m_gridRows - 1);
+
+    for (int y = lastY; y >= firstY; y--)
+    {
+        for (int x = firstX; x <= lastX;)
+        {
+            // occupied cells from x to the end of its word (or the collider)
+            std::uint32_t bits = m_field.occupiedFrom(x, y);
+            const int     end  = std::min(lastX + 1, x - x % ShroomField::WordBits + ShroomField::WordBits);
+            for (; bits != 0 && x < end; x++, bits >>= 1)
+            {
+                if ((bits & 1u) == 0)
+                {
+                    continue;
+                }
+                const std::uint32_t index = m_grid[static_cast<std::size_t>(y) * static_cast<std::size_t>(m_gridColumns) + static_cast<std::size_t>(x)];
+                if (collider.intersects(m_shrooms[index].getCollider()))
+                {
+                    return index;
+                }
+            }
+            x = end;
+        }
+    }
+    return MushroomManager::NoShroom;
+}
+
+/** Cells outside what a Shroom can store are a bug in the caller (the game area is a few dozen cells) */
+void MushroomManager::place(Vec2f location)
+{
+    const Cell cell = MushroomManager::cellOf(location);
+    if (cell.x < Shroom::MinCell || cell.x > Shroom::MaxCell || cell.y < Shroom::MinCell || cell.y > Shroom::MaxCell)
+    {
+        throw std::runtime_error("Mushroom placed out of range");
+    }
+    if (this->gridAt(cell) == nullptr)
+    {
+        this->growGrid(cell, cell);
+    }
+    std::uint32_t& entry = *this->gridAt(cell);
+    if (entry != MushroomManager::NoShroom)
+    {
+        return;
+    }
+
+    std::uint32_t slot = m_slotCount;
+    if (m_freeSlots.empty())
+    {
+        if (m_slotCount > Shroom::MaxSlot)
+        {
+            throw std::runtime_error("Too many mushrooms");
+        }
+        m_slotCount++;
+    }
+    else
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    entry                = static_cast<std::uint32_t>(m_shrooms.size());
+    const Shroom& shroom = m_shrooms.emplace_back(cell.x, cell.y, slot);
+    this->setField(shroom);
+    if (m_listener != nullptr)
+    {
+        m_listener->shroomChanged(shroom);
+    }
+}
+
+/** Swapping the last mushroom into the hole keeps the array dense, only its grid entry changes */
+void MushroomManager::remove(std::uint32_t index)
+{
+    const Shroom& shroom = m_shrooms[index];
+    *this->gridAt({shroom.getColumn(), shroom.getRow()}) = MushroomManager::NoShroom;
+    this->setField(shroom, true);
+    m_freeSlots.push_back(shroom.getSlot());
+    if (m_listener != nullptr)
+    {
+        m_listener->shroomRemoved(shroom);
+    }
+
+    if (index + 1 != m_shrooms.size())
+    {
+        m_shrooms[index] = m_shrooms.back();
+        *this->gridAt({m_shrooms[index].getColumn(), m_shrooms[index].getRow()}) = index;
+    }
+    m_shrooms.pop_back();
+}
+
+void MushroomManager::save(ByteWriter& out) const
+{
+    out.varint(m_shrooms.size());
+    for (const auto& shroom : m_shrooms)
+    {
+        shroom.save(out);
+    }
+    m_rng.save(out);
+}
+
+/** The array is rebuilt in the saved order, at most one mushroom per cell */
+void MushroomManager::restore(ByteReader& in)
+{
+    m_shrooms.clear();
+    m_freeSlots.clear();
+    m_slotCount = 0;
+    m_grid.assign(m_grid.size(), MushroomManager::NoShroom);
+    m_field.reset(m_gridColumns, m_gridRows);
+
+    const std::uint64_t count = in.varint();
+    for (std::uint64_t i = 0; i < count; i++)
+    {
+        if (m_slotCount > Shroom::MaxSlot)
+        {
+            in.fail("Too many mushrooms in");
+        }
+        // read into a local first, growing the grid reserves (and so may move) m_shrooms
+        Shroom shroom{0, 0, m_slotCount++};
+        shroom.restore(in);
+
+        const Cell cell{shroom.getColumn(), shroom.getRow()};
+        if (this->gridAt(cell) == nullptr)
+        {
+            this->growGrid(cell, cell);
+        }
+        std::uint32_t& entry = *this->gridAt(cell);
+        if (entry != MushroomManager::NoShroom)
+        {
+            in.fail("Overlapping mushrooms in");
+        }
+        entry = static_cast<std::uint32_t>(m_shrooms.size());
+        m_shrooms.push_back(shroom);
+        this->setField(shroom);
+    }
+    m_rng.restore(in);
+
+    if (m_listener != nullptr)
+    {
+        m_listener->shroomsReset(*this);
+    }
 }
@@ -8,78 +8,205 @@ It creates a collection of Shroom objects, and handles their state throughout th
 */
 
 #pragma once
-#include <list>
-#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
-#include <SFML/Graphics.hpp>
+#include "Geometry.hpp"
+#include "Random.hpp"
+#include "Serialize.hpp"
 
-class Shroom : public sf::Sprite
+/**
+ * A mushroom is a tiny record: its grid cell, health and slot packed in 8 bytes.
+ * Everything else (position, collider, edges) is derived from the cell on demand.
+ */
+class Shroom
 {
   public:
+    /** Size of every mushroom (px) */
+    static constexpr Vec2f Size{8, 8};
+
+    /** The health of a new mushroom */
+    static constexpr int MaxHealth = 4;
+
+    /** Highest slot a mushroom can have (the slot shares 32 bits with the health) */
+    static constexpr std::uint32_t MaxSlot = (1u << 28) - 1;
+
+    /** Cells a mushroom can be in, in both directions */
+    static constexpr int MinCell = INT16_MIN;
+    static constexpr int MaxCell = INT16_MAX;
+
     /**
-     * Construct a new Shroom centered at postion (x,y)
-     * @param x coordinate of center
-     * @param y coordinate of center
+     * Construct a new Shroom in a cell of the Game::GridSize grid
+     * @param column,row cell of the grid, counted from the world origin (MinCell to MaxCell)
+     * @param slot stable index of this mushroom in its manager (see MushroomListener)
      */
-    Shroom(float x, float y);
-    Shroom(sf::Vector2f location);
+    Shroom(int column, int row, std::uint32_t slot = 0);
     Shroom() = delete; // no default constructor
 
-    /** Decrement the health of this mushroom, and cycle through the textures.
+    /** Decrement the health of this mushroom.
+     *  The renderer picks a more damaged texture for each level.
      *  @return remaining health
      */
     int damage();
 
-    /**
-     * Get the x,y position of the left side in world space.
-     * The y position is simply the center of the mushroom sprite.
-     * @return sf::Vector2f (x,y)
-     */
-    sf::Vector2f getLeftEdge() const;
+    /** @return remaining health (1 to MaxHealth while alive) */
+    int getHealth() const;
+
+    /** @return the grid column of the mushroom */
+    int getColumn() const;
+
+    /** @return the grid row of the mushroom */
+    int getRow() const;
+
+    /** @return the center of the mushroom */
+    Vec2f getPosition() const;
+
+    /** @return the stable index of this mushroom, unique among living mushrooms of a manager */
+    std::uint32_t getSlot() const;
+
+    /** @return the bounding box of the mushroom */
+    FloatRect getCollider() const;
+
+    /** Write position and health to a snapshot */
+    void save(ByteWriter& out) const;
+
+    /** Read back the state written by save() (the position must be the center of a cell) */
+    void restore(ByteReader& in);
+
+  private:
+    /** Cell of the mushroom */
+    std::int16_t m_column;
+    std::int16_t m_row;
+
+    /** Stable index in the manager, reused after this mushroom is destroyed */
+    std::uint32_t m_slot : 28;
+
+    /** The health of mushroom (starts at 4) */
+    std::uint32_t m_health : 4;
+};
+
+/**
+ * Bitboards of a grid of mushrooms, one bit per cell.
+ * Every row is getRowWords() 32-bit words (a single word for the 30 columns of the game).
+ * The occupancy plane and two health planes (health - 1) are stored one after the other,
+ * so a copy of the whole game field is one block of 360 bytes.
+ *
+ * Cells are counted from the top-left of the field, 0 to columns - 1 and rows - 1.
+ */
+class ShroomField
+{
+  public:
+    /** Cells in each word of a row */
+    static constexpr int WordBits = 32;
+
+    /** Empty the field, and resize it to columns x rows cells */
+    void reset(int columns, int rows);
+
+    /** @return true if the cell has a mushroom */
+    bool has(int column, int row) const;
 
     /**
-     * Get the x,y position of the right side in world space.
-     * The y position is simply the center of the mushroom sprite.
-     * @return sf::Vector2f (x,y)
+     * Set the health of the mushroom in a cell
+     * @param health 1 to Shroom::MaxHealth, or 0 to empty the cell
      */
-    sf::Vector2f getRightEdge() const;
+    void setHealth(int column, int row, int health);
+
+    /** @return the occupancy bits of `row`, starting at cell `column` (which is bit 0) to the end of its word */
+    std::uint32_t occupiedFrom(int column, int row) const;
+
+    /** @return number of columns */
+    int getColumns() const;
+
+    /** @return number of rows */
+    int getRows() const;
+
+    /** @return number of words in each row of a plane */
+    int getRowWords() const;
 
   private:
-    // Constant regions for mushroom textures in the sprite-sheet
-    static inline const sf::IntRect FullTexOffset{104, 107, 8, 8};
-    static inline const sf::IntRect Damage1TexOffset{152, 107, 8, 8};
-    static inline const sf::IntRect Damage2TexOffset{136, 107, 8, 8};
-    static inline const sf::IntRect Damage3TexOffset{120, 107, 8, 8};
+    /** Planes of the field, in storage order */
+    enum Plane : std::size_t { Occupied, HealthLow, HealthHigh, PlaneCount };
 
-    /** The health of mushroom (starts at 4) */
-    int m_health = 4;
+    /** @return index of the word holding a cell in a plane */
+    std::size_t wordOf(Plane plane, int column, int row) const;
+
+    int m_columns  = 0;
+    int m_rows     = 0;
+    int m_rowWords = 0;
+
+    /** Every plane, row-major */
+    std::vector<std::uint32_t> m_bits;
 };
 
+class MushroomManager;
+
 /**
- * MushroomManager is used to operate on all mushroom sprites in the scene.
- * Each mushroom starts with the same texture.
+ * Receives every change to a MushroomManager's mushrooms, so a front end can keep
+ * its own copy (e.g. a vertex buffer) in sync without rescanning every mushroom.
+ * Mushrooms are identified by their slot.
  */
-class MushroomManager : public sf::Drawable
+class MushroomListener
 {
   public:
+    virtual ~MushroomListener() = default;
+
+    /** A mushroom was placed, or its health changed */
+    virtual void shroomChanged(const Shroom& shroom) = 0;
+
+    /** A mushroom was destroyed, its slot is free until the next placement */
+    virtual void shroomRemoved(const Shroom& shroom) = 0;
+
+    /** Every mushroom may have changed (a new listener, or a restored snapshot) */
+    virtual void shroomsReset(const MushroomManager& mushrooms) = 0;
+};
+
+/**
+ * MushroomManager is used to operate on all mushrooms in the scene.
+ * Each mushroom starts with full health.
+ *
+ * Mushrooms sit on the Game::GridSize lattice (starting at the world origin), at most one
+ * per cell. They are stored densely in a vector (in no particular order), and destroying
+ * one moves the last mushroom into its place. Slots stay stable for the listener.
+ * Storage is reserved for a mushroom in every cell, so the arrays never reallocate.
+ *
+ * A grid of cells holds the index of each mushroom, and a ShroomField covering the same
+ * cells holds their occupancy and health as bits. Collision queries scan the occupancy
+ * bits of the cells they overlap, and only look up the mushrooms they find.
+ * Both grow if a mushroom is placed outside of them.
+ */
+class MushroomManager
+{
+  public:
+    /** Number of mushrooms at the start of a game */
+    static constexpr std::size_t StartCount = 30;
+
     /** Construct the Mushroom Manager object
      * and create a bunch of mushrooms with random positions
+     *
+     * @param bounds Rectangle where mushrooms should be placed
+     * @param seed the same seed always places the same mushrooms
+     * @param count number of mushrooms to place (larger scenes are used by the benchmarks)
      */
-    MushroomManager(sf::FloatRect bounds);
+    MushroomManager(FloatRect bounds, std::uint32_t seed, std::size_t count = MushroomManager::StartCount);
     MushroomManager() = delete; // no default constructor
 
     /**
-     * Draw all active mushrooms to the scene
-     * Implements sf::Drawable.draw
+     * Add a new mushroom to the collection, in the grid cell containing `location`.
+     * Nothing is added if that cell already has a mushroom.
+     *
+     * @param location any point in the cell
      */
-    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+    void addMushroom(Vec2f location);
 
     /**
-     * Add a new mushroom to the collection
-     *
-     * @param location coordinate of top-left corner
+     * Make room for mushrooms anywhere in `area` up front, so placing them there never allocates.
+     * @param area any area (the grid only grows)
      */
-    void addMushroom(sf::Vector2f location);
+    void reserve(FloatRect area);
+
+    /** @return true if a grid cell (column, row from the world origin) has a mushroom */
+    bool hasShroom(int column, int row) const;
 
     /**
      * Checks for a spider colliding with any mushroom.
@@ -88,7 +215,7 @@ class MushroomManager : public sf::Drawable
      * @param spider The spider collider
      * @return true if the spider hit a mushroom
      */
-    bool checkSpiderCollision(sf::FloatRect other);
+    bool checkSpiderCollision(FloatRect other);
 
     /**
      * Checks for a laser colliding with any mushroom.
@@ -96,21 +223,110 @@ class MushroomManager : public sf::Drawable
      * @param laser The laser collider
      * @return true if the laser hit a mushroom
      */
-    bool checkLaserCollision(sf::FloatRect laser);
+    bool checkLaserCollision(FloatRect laser);
+
+    /**
+     * Get a reference to the mushrooms for easy iteration
+     * @return read-only reference to the internal array (in no particular order)
+     */
+    const std::vector<Shroom>& getShrooms() const;
+
+    /**
+     * Get the bitboards of every mushroom
+     * @return read-only reference to the field, which covers getFieldArea()
+     */
+    const ShroomField& getField() const;
+
+    /** @return the area covered by the field (whole grid cells) */
+    FloatRect getFieldArea() const;
+
+    /** @return the area where mushrooms are placed at the start */
+    FloatRect getBounds() const;
+
+    /** @return one more than the highest slot in use (slots below it may be free) */
+    std::uint32_t getSlotCount() const;
+
+    /**
+     * Send every change to `listener` (nullptr to stop).
+     * The listener is reset straight away with the current mushrooms.
+     */
+    void setListener(MushroomListener* listener);
+
+    /** Write every mushroom and the random number engine to a snapshot */
+    void save(ByteWriter& out) const;
+
+    /** Replace every mushroom with the ones written by save() */
+    void restore(ByteReader& in);
 
     /**
-     * Get a reference to the list of mushroom sprites for easy iteration
-     * @return read-only reference to the internal list
+     * Exchange every mushroom, the grid and the engine with `other`.
+     * Each manager keeps its own listener, which is reset with its new mushrooms.
      */
-    const std::list<Shroom>& getShrooms() const;
+    void swap(MushroomManager& other);
 
   private:
-    /** Collection of mushroom sprites that this class manages */
-    std::list<Shroom> m_shrooms;
+    /** A cell of the mushroom grid (column, row from the world origin) */
+    struct Cell
+    {
+        int x;
+        int y;
+    };
+
+    /** Grid entry of an empty cell */
+    static constexpr std::uint32_t NoShroom = UINT32_MAX;
+
+    /** Collection of mushrooms that this class manages */
+    std::vector<Shroom> m_shrooms;
+
+    /** Cells covered by the grid */
+    Cell m_gridOrigin{0, 0};
+    int  m_gridColumns = 0;
+    int  m_gridRows    = 0;
+
+    /** Index in m_shrooms of the mushroom in each cell, or NoShroom (row-major) */
+    std::vector<std::uint32_t> m_grid;
+
+    /** Occupancy and health of each cell of the grid */
+    ShroomField m_field;
 
     /** Area where mushroom can be placed */
-    sf::FloatRect m_bounds;
+    FloatRect m_bounds;
 
     /** Mersenne twister random number engine (for random positioning) */
-    std::mt19937 m_rng;
+    Game::Rng m_rng;
+
+    /** Slots of destroyed mushrooms, reused first */
+    std::vector<std::uint32_t> m_freeSlots;
+
+    /** Slots ever handed out */
+    std::uint32_t m_slotCount = 0;
+
+    /** Receives every change (not owned) */
+    MushroomListener* m_listener = nullptr;
+
+    /** @return the cell containing `point` */
+    static Cell cellOf(Vec2f point);
+
+    /** @return the grid entry of a cell, or nullptr if the cell is outside the grid */
+    std::uint32_t*       gridAt(Cell cell);
+    const std::uint32_t* gridAt(Cell cell) const;
+
+    /** Resize the grid to cover the cells from `first` to `last` as well (nothing happens if it already does) */
+    void growGrid(Cell first, Cell last);
+
+    /** Copy the health of a mushroom to its cell of the field (or empty the cell if it was `removed`) */
+    void setField(const Shroom& shroom, bool removed = false);
+
+    /**
+     * Find a mushroom intersecting `collider`, scanning the occupancy bits of the cells it overlaps.
+     * Lower rows are checked first (closest to the player).
+     * @return index of the mushroom, or NoShroom
+     */
+    std::uint32_t findHit(FloatRect collider) const;
+
+    /** Create a mushroom in a free slot of the cell containing `location` (if empty), and tell the listener */
+    void place(Vec2f location);
+
+    /** Destroy a mushroom (moving the last one into its index), free its slot, and tell the listener */
+    void remove(std::uint32_t index);
 };
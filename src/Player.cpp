@@ -8,27 +8,19 @@ The player can move around a given bounds using the WASD or arrow keys.
 If a enemy collides with the player, a life is lost.
 */
 
-#include "SFML/Graphics.hpp"
+#include <cstdint>
 
 #include "Player.hpp"
-#include "TextureManager.hpp"
 
-/** Constructor initializes the Sprite and other members and sets the origin to the center. */
-Player::Player(sf::FloatRect bounds)
+/** Constructor initializes the members, shrinking the bounds to account for the centered origin. */
+Player::Player(FloatRect bounds)
 {
-    this->setTexture(TextureManager::GetTexture("graphics/sprites.png"));
-    this->setTextureRect(Player::PlayerTexOffset);
-
-    // use the sprite size to center the origin
-    const auto& size = this->getLocalBounds();
-    this->setOrigin(size.width / 2.f, size.height / 2.f);
-
     // adjust the bounds to account for offset sprite center
-    bounds.left += size.width / 2.f;
-    bounds.top += size.height / 2.f;
+    bounds.left += Player::Size.x / 2.f;
+    bounds.top += Player::Size.y / 2.f;
 
-    bounds.width -= size.width;
-    bounds.height -= size.height;
+    bounds.width -= Player::Size.x;
+    bounds.height -= Player::Size.y;
     m_bounds = bounds;
 
     // move to starting position
@@ -45,19 +37,17 @@ void Player::spawn()
 void Player::reset()
 {
     // reset position
-    sf::Vector2f start{m_bounds.left + (m_bounds.width / 2), // center
-                       m_bounds.top + m_bounds.height};      // bottom row
-    this->setPosition(start);
+    this->moveTo({m_bounds.left + (m_bounds.width / 2), // center
+                  m_bounds.top + m_bounds.height});     // bottom row
 }
 
-/** Set movement flags based on current keyboard input */
-void Player::handleInput()
+/** Set movement flags from the sampled controls */
+void Player::setInput(const Input& input)
 {
-    // Can be moved with arrows or WASD
-    m_movingUp    = sf::Keyboard::isKeyPressed(sf::Keyboard::W) || sf::Keyboard::isKeyPressed(sf::Keyboard::Up);
-    m_movingDown  = sf::Keyboard::isKeyPressed(sf::Keyboard::S) || sf::Keyboard::isKeyPressed(sf::Keyboard::Down);
-    m_movingLeft  = sf::Keyboard::isKeyPressed(sf::Keyboard::A) || sf::Keyboard::isKeyPressed(sf::Keyboard::Left);
-    m_movingRight = sf::Keyboard::isKeyPressed(sf::Keyboard::D) || sf::Keyboard::isKeyPressed(sf::Keyboard::Right);
+    m_movingUp    = input.up;
+    m_movingDown  = input.down;
+    m_movingLeft  = input.left;
+    m_movingRight = input.right;
 }
 
 /**
@@ -68,8 +58,8 @@ void Player::update(float deltaTime)
 {
     // moves `Speed` pixels every second.
     // opposite directions cancel out.
-    const float  distance = Player::Speed * deltaTime;
-    sf::Vector2f pos      = this->getPosition();
+    const float distance = Player::Speed * deltaTime;
+    Vec2f       pos      = m_position;
 
     if (m_movingUp)
     {
@@ -95,17 +85,17 @@ void Player::update(float deltaTime)
     auto saturate = [](float v, float lo, float hi) { return v < lo ? lo : v > hi ? hi : v; };
 
     // prevent movement out of the player bounding area
-    // not using sf::Rec.contains() because of 'sticky' walls issue
+    // not using Rect.contains() because of 'sticky' walls issue
     pos.x = saturate(pos.x, m_bounds.left, m_bounds.width + m_bounds.left);
     pos.y = saturate(pos.y, m_bounds.top, m_bounds.height + m_bounds.top);
 
-    this->setPosition(pos);
+    this->moveTo(pos);
 }
 
 /** Detect if hit by the spider and lose a life */
-bool Player::checkSpiderCollision(sf::FloatRect spider)
+bool Player::checkSpiderCollision(FloatRect spider)
 {
-    if (this->getGlobalBounds().intersects(spider))
+    if (this->getCollider().intersects(spider))
     {
         m_lives--;
         this->reset();
@@ -114,9 +104,9 @@ bool Player::checkSpiderCollision(sf::FloatRect spider)
     return false;
 }
 
-bool Player::checkMushroomCollision(sf::FloatRect shroom)
+bool Player::checkMushroomCollision(FloatRect shroom)
 {
-    if (this->getGlobalBounds().intersects(shroom))
+    if (this->getCollider().intersects(shroom))
     {
         m_colliding = true;
     }
@@ -132,8 +122,57 @@ bool Player::isDead() const
     return m_lives <= 0;
 }
 
+int Player::getLives() const
+{
+    return m_lives;
+}
+
 /** Calculate the offset from center origin that the top of the laster should start from. */
-sf::Vector2f Player::getGunPosition() const
+Vec2f Player::getGunPosition() const
+{
+    return m_position + Vec2f{0.0, Player::Size.y / 2.f};
+}
+
+Vec2f Player::getPosition() const
+{
+    return m_position;
+}
+
+const FloatRect& Player::getCollider() const
 {
-    return this->getPosition() + sf::Vector2f(0.0, this->getLocalBounds().height / 2.f);
+    return m_collider;
+}
+
+void Player::moveTo(Vec2f position)
+{
+    m_position = position;
+    m_collider = centeredRect(m_position, Player::Size);
+}
+
+void Player::save(ByteWriter& out) const
+{
+    out.vec(m_position);
+    out.flag(m_movingUp);
+    out.flag(m_movingDown);
+    out.flag(m_movingLeft);
+    out.flag(m_movingRight);
+    out.flag(m_colliding);
+    out.le(static_cast<std::uint32_t>(m_lives), 4); // negative once the game is over
+}
+
+/** update() clamps the position to the bounds, so a saved position is always inside them */
+void Player::restore(ByteReader& in)
+{
+    this->moveTo(in.vecWithin(m_bounds));
+    m_movingUp    = in.flag();
+    m_movingDown  = in.flag();
+    m_movingLeft  = in.flag();
+    m_movingRight = in.flag();
+    m_colliding   = in.flag();
+
+    m_lives = static_cast<std::int32_t>(static_cast<std::uint32_t>(in.le(4)));
+    if (m_lives > Player::StartingLives)
+    {
+        in.fail("Invalid lives in");
+    }
 }
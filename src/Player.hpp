@@ -8,17 +8,22 @@ Player character declaration.
 
 #pragma once
 
-#include <SFML/Graphics.hpp>
+#include "Geometry.hpp"
+#include "Input.hpp"
+#include "Serialize.hpp"
 
 /**
- * The Player class inherits from SFML Sprite and implements:
- * user input, spider collisions, and keeping track of lives
+ * The Player class implements:
+ * movement from input, spider collisions, and keeping track of lives
  */
-class Player : public sf::Sprite
+class Player
 {
   public:
+    /** Size of the player starship (px) */
+    static constexpr Vec2f Size{7, 8};
+
     /** Construct a new Player object */
-    Player(sf::FloatRect bounds);
+    Player(FloatRect bounds);
 
     // no default constructor
     Player() = delete;
@@ -26,10 +31,13 @@ class Player : public sf::Sprite
     /** Start the player in the middle of defined player area */
     void spawn();
 
-    /** Do player movement */
-    void handleInput();
+    /**
+     * Set the movement flags from the controls for this tick.
+     * @param input the controls for this tick (fire is handled by the World)
+     */
+    void setInput(const Input& input);
 
-    /** Update player sprite position based on elapsed seconds
+    /** Update player position based on elapsed seconds
      * @param deltaTime time in seconds since last update
      */
     void update(float deltaTime);
@@ -40,7 +48,7 @@ class Player : public sf::Sprite
      * @return true if hit by spider
      * @return false otherwise
      */
-    bool checkSpiderCollision(sf::FloatRect spider);
+    bool checkSpiderCollision(FloatRect spider);
 
     /**
      * Check fo collisions with mushrooms, and prevent movement
@@ -48,7 +56,7 @@ class Player : public sf::Sprite
      * @return true if colliding
      * @return false
      */
-    bool checkMushroomCollision(sf::FloatRect shroom);
+    bool checkMushroomCollision(FloatRect shroom);
 
     /**
      * Determine if all the lives are used up.
@@ -58,12 +66,27 @@ class Player : public sf::Sprite
      */
     bool isDead() const;
 
+    /** @return the current lives remaining */
+    int getLives() const;
+
     /**
      * Return the location that the lasers should spawn from.
      *
-     * @return sf::Vector2f
+     * @return Vec2f
      */
-    sf::Vector2f getGunPosition() const;
+    Vec2f getGunPosition() const;
+
+    /** @return the center of the player */
+    Vec2f getPosition() const;
+
+    /** @return the bounding box of the player (kept up to date as the player moves) */
+    const FloatRect& getCollider() const;
+
+    /** Write position, held controls and lives to a snapshot */
+    void save(ByteWriter& out) const;
+
+    /** Read back the state written by save() */
+    void restore(ByteReader& in);
 
   private:
     /** Player movement speed in pixels/second */
@@ -72,14 +95,20 @@ class Player : public sf::Sprite
     /** How many lives the player has at start */
     static constexpr int StartingLives = 3;
 
-    /** Location of the player texture in sprite-sheet */
-    static inline const sf::IntRect PlayerTexOffset{12, 171, 7, 8};
-
     /** Move back to the starting position. */
     void reset();
 
+    /** Set the position, and the collider around it */
+    void moveTo(Vec2f position);
+
     /** The bounds of player movement */
-    sf::FloatRect m_bounds;
+    FloatRect m_bounds;
+
+    /** Center of the player */
+    Vec2f m_position;
+
+    /** Bounding box around m_position */
+    FloatRect m_collider;
 
     /** Up movement key is pressed */
     bool m_movingUp = false;
@@ -0,0 +1,140 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Profiler ring buffer, percentile and CSV definitions.
+*/
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "Profiler.hpp"
+
+const char* Profiler::name(Phase phase)
+{
+    switch (phase)
+    {
+    case Phase::Input:
+        return "input";
+    case Phase::Spider:
+        return "spider";
+    case Phase::Lasers:
+        return "lasers";
+    case Phase::Centipede:
+        return "centipede";
+    case Phase::Movement:
+        return "movement";
+    case Phase::Draw:
+        return "draw";
+    case Phase::Frame:
+        return "frame";
+    case Phase::Count:
+        break;
+    }
+    return "unknown";
+}
+
+void Profiler::add(Phase phase, float micros)
+{
+    m_current[static_cast<std::size_t>(phase)] += micros;
+}
+
+/** The Frame phase is the total of every other phase */
+void Profiler::endFrame()
+{
+    float total = 0;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(Phase::Frame); i++)
+    {
+        total += m_current[i];
+    }
+    m_current[static_cast<std::size_t>(Phase::Frame)] = total;
+
+    m_frames[m_next] = m_current;
+    m_current.fill(0);
+
+    m_next  = (m_next + 1) % Profiler::Capacity;
+    m_count = std::min(m_count + 1, Profiler::Capacity);
+    m_frameNumber++;
+}
+
+/** Percentiles are found with nth_element on a copy of the kept samples */
+PhaseStats Profiler::stats(Phase phase) const
+{
+    PhaseStats result;
+    if (m_count == 0)
+    {
+        return result;
+    }
+
+    std::vector<float> samples(m_count);
+    for (std::size_t i = 0; i < m_count; i++)
+    {
+        samples[i] = this->sample(i, phase);
+    }
+
+    auto percentile = [&](std::size_t percent) {
+        const std::size_t rank = (samples.size() - 1) * percent / 100;
+        std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+        return samples[rank];
+    };
+
+    result.p50 = percentile(50);
+    result.p99 = percentile(99);
+    result.max = *std::max_element(samples.begin(), samples.end());
+    return result;
+}
+
+std::size_t Profiler::getFrames() const
+{
+    return m_count;
+}
+
+float Profiler::sample(std::size_t frame, Phase phase) const
+{
+    // the oldest kept frame is the next one to be overwritten
+    const std::size_t oldest = (m_next + Profiler::Capacity - m_count) % Profiler::Capacity;
+    return m_frames[(oldest + frame) % Profiler::Capacity][static_cast<std::size_t>(phase)];
+}
+
+bool Profiler::writeCsv(const std::string& path) const
+{
+    std::ofstream file{path};
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "frame";
+    for (std::size_t p = 0; p < Profiler::PhaseCount; p++)
+    {
+        file << ',' << Profiler::name(static_cast<Phase>(p)) << "_us";
+    }
+    file << '\n';
+
+    const std::uint64_t first = m_frameNumber - m_count;
+    for (std::size_t i = 0; i < m_count; i++)
+    {
+        file << first + i;
+        for (std::size_t p = 0; p < Profiler::PhaseCount; p++)
+        {
+            file << ',' << this->sample(i, static_cast<Phase>(p));
+        }
+        file << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+ScopedTimer::ScopedTimer(Profiler* profiler, Phase phase) : m_profiler{profiler}, m_phase{phase}, m_start{std::chrono::steady_clock::now()}
+{
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    if (m_profiler != nullptr)
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - m_start;
+        m_profiler->add(m_phase, std::chrono::duration<float, std::micro>(elapsed).count());
+    }
+}
@@ -0,0 +1,128 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Per-phase frame timing. Timings go into a fixed-size ring buffer of recent frames,
+which reports p50/p99/max for each phase and can be dumped to CSV.
+
+The CENTIPEDE_PROFILE() timers only exist when CENTIPEDE_PROFILING is defined
+(CMake option CENTIPEDE_ENABLE_PROFILING). Otherwise they compile to nothing.
+*/
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/** Parts of a frame that are timed separately */
+enum class Phase : std::size_t {
+    Input,     // Engine::input() event and keyboard polling
+    Spider,    // spider vs. mushroom and player collisions
+    Lasers,    // laser collisions and movement
+    Centipede, // Centipede::update() (movement and mushroom collisions)
+    Movement,  // spider and player movement
+    Draw,      // Engine::draw() up to display
+    Frame,     // sum of all the above
+    Count
+};
+
+/** Summary of the recent timings of one phase (microseconds) */
+struct PhaseStats
+{
+    float p50 = 0;
+    float p99 = 0;
+    float max = 0;
+};
+
+/**
+ * Collects the time spent in each Phase, one row per frame.
+ * Only the most recent Profiler::Capacity frames are kept.
+ */
+class Profiler
+{
+  public:
+    /** Number of frames kept (a bit over a minute at 60fps) */
+    static constexpr std::size_t Capacity = 4096;
+
+    /** Number of timed phases */
+    static constexpr std::size_t PhaseCount = static_cast<std::size_t>(Phase::Count);
+
+    /** @return a short name for a phase (used for CSV columns) */
+    static const char* name(Phase phase);
+
+    /**
+     * Add time to a phase of the current frame
+     * @param phase the phase that was timed
+     * @param micros duration in microseconds
+     */
+    void add(Phase phase, float micros);
+
+    /** Finish the current frame, and push it into the ring buffer */
+    void endFrame();
+
+    /** @return p50/p99/max of a phase over the kept frames */
+    PhaseStats stats(Phase phase) const;
+
+    /** @return number of kept frames */
+    std::size_t getFrames() const;
+
+    /**
+     * Get a kept timing
+     * @param frame index of a kept frame, 0 is the oldest
+     * @param phase the phase to read
+     * @return duration in microseconds
+     */
+    float sample(std::size_t frame, Phase phase) const;
+
+    /**
+     * Write every kept frame to a CSV file, one row per frame
+     * @return false if the file can't be written
+     */
+    bool writeCsv(const std::string& path) const;
+
+  private:
+    using Row = std::array<float, PhaseCount>;
+
+    /** Ring buffer of recent frames */
+    std::array<Row, Capacity> m_frames{};
+
+    /** Timings of the frame in progress */
+    Row m_current{};
+
+    /** Next slot to write in the ring buffer */
+    std::size_t m_next = 0;
+
+    /** Number of valid slots in the ring buffer */
+    std::size_t m_count = 0;
+
+    /** Total frames ever finished (numbers the CSV rows) */
+    std::uint64_t m_frameNumber = 0;
+};
+
+/** Times its own lifetime, and adds it to a Profiler phase (if there is a profiler) */
+class ScopedTimer
+{
+  public:
+    ScopedTimer(Profiler* profiler, Phase phase);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&)            = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  private:
+    Profiler*                             m_profiler;
+    Phase                                 m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#ifdef CENTIPEDE_PROFILING
+#define CENTIPEDE_PROFILE_JOIN2(a, b) a##b
+#define CENTIPEDE_PROFILE_JOIN(a, b)  CENTIPEDE_PROFILE_JOIN2(a, b)
+/** Time the rest of the enclosing scope as `phase` */
+#define CENTIPEDE_PROFILE(profiler, phase) const ScopedTimer CENTIPEDE_PROFILE_JOIN(profileTimer, __LINE__)((profiler), (phase))
+#else
+#define CENTIPEDE_PROFILE(profiler, phase) static_cast<void>(0)
+#endif
@@ -0,0 +1,93 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Defines the profiler overlay bars and histogram.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <SFML/Graphics.hpp>
+
+#include "ProfilerOverlay.hpp"
+#include "Settings.hpp"
+
+void ProfilerOverlay::update(const Profiler& profiler)
+{
+    m_vertices.clear();
+
+    const float rows            = static_cast<float>(Profiler::PhaseCount);
+    const float histogramTop    = rows * RowHeight + 2;
+    const float overlayHeight   = histogramTop + HistogramHeight;
+    const float budgetMicros    = Game::Tick * 1e6f;
+    const float pixelsPerDecade = Width / Decades;
+
+    // darken the game behind the overlay
+    this->addRect(0, 0, Width, overlayHeight, sf::Color(0, 0, 0, 200));
+
+    // decade grid lines (10us, 100us, 1ms, 10ms)
+    for (int decade = 1; decade < static_cast<int>(Decades); decade++)
+    {
+        this->addRect(static_cast<float>(decade) * pixelsPerDecade, 0, 1, overlayHeight, sf::Color(60, 60, 60));
+    }
+
+    // one row of percentile bars per phase
+    for (std::size_t p = 0; p < Profiler::PhaseCount; p++)
+    {
+        const PhaseStats stats = profiler.stats(static_cast<Phase>(p));
+        const float      top   = static_cast<float>(p) * RowHeight;
+        this->addRect(0, top + 1, toX(stats.max), RowHeight - 2, sf::Color(110, 110, 110));
+        this->addRect(0, top + 1, toX(stats.p99), RowHeight - 2, sf::Color(255, 150, 0));
+        this->addRect(0, top + 1, toX(stats.p50), RowHeight - 2, sf::Color(0, 200, 0));
+    }
+
+    // histogram of whole frame times, on the same log scale
+    std::array<std::size_t, Bins> counts{};
+    for (std::size_t i = 0; i < profiler.getFrames(); i++)
+    {
+        const float       x   = toX(profiler.sample(i, Phase::Frame));
+        const std::size_t bin = std::min(Bins - 1, static_cast<std::size_t>(x / Width * static_cast<float>(Bins)));
+        counts[bin]++;
+    }
+
+    const std::size_t tallest  = std::max<std::size_t>(1, *std::max_element(counts.begin(), counts.end()));
+    const float       binWidth = Width / static_cast<float>(Bins);
+    for (std::size_t bin = 0; bin < Bins; bin++)
+    {
+        const float height = HistogramHeight * static_cast<float>(counts[bin]) / static_cast<float>(tallest);
+        this->addRect(static_cast<float>(bin) * binWidth, overlayHeight - height, binWidth - 1, height, sf::Color(0, 160, 255));
+    }
+
+    // 60fps frame budget
+    this->addRect(toX(budgetMicros), 0, 1, overlayHeight, sf::Color::Red);
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    target.draw(m_vertices, states);
+}
+
+/** 1us is the left edge, 100ms is the right edge */
+float ProfilerOverlay::toX(float micros)
+{
+    const float x = std::log10(std::max(micros, 1.f)) / Decades * Width;
+    return std::min(x, Width);
+}
+
+void ProfilerOverlay::addRect(float left, float top, float width, float height, sf::Color color)
+{
+    const sf::Vector2f tl{left, top};
+    const sf::Vector2f tr{left + width, top};
+    const sf::Vector2f br{left + width, top + height};
+    const sf::Vector2f bl{left, top + height};
+
+    m_vertices.append(sf::Vertex(tl, color));
+    m_vertices.append(sf::Vertex(tr, color));
+    m_vertices.append(sf::Vertex(br, color));
+    m_vertices.append(sf::Vertex(tl, color));
+    m_vertices.append(sf::Vertex(br, color));
+    m_vertices.append(sf::Vertex(bl, color));
+}
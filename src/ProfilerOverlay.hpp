@@ -0,0 +1,62 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+On-screen view of the Profiler (toggled with F3 when profiling is enabled).
+*/
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "Profiler.hpp"
+
+/**
+ * Draws the recent frame timings over the game, on a log scale from 1us to 100ms.
+ *
+ * The top has one row per Phase with three bars: max (grey), p99 (orange) and p50 (green).
+ * Below is a histogram of the whole frame times, with a red line at the 60fps budget.
+ * There is no font in the game, so decade grid lines mark 10us, 100us, 1ms and 10ms.
+ */
+class ProfilerOverlay : public sf::Drawable
+{
+  public:
+    /** Rebuild the bars from the latest timings */
+    void update(const Profiler& profiler);
+
+    /**
+     * Draw the overlay to the target (in game view coordinates)
+     * Implements sf::Drawable.draw
+     */
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+  private:
+    /** Width of the overlay (px) */
+    static constexpr float Width = 240;
+
+    /** Height of each phase row (px) */
+    static constexpr float RowHeight = 6;
+
+    /** Height of the tallest histogram bar (px) */
+    static constexpr float HistogramHeight = 40;
+
+    /** Number of histogram bins (across the whole log scale) */
+    static constexpr std::size_t Bins = 60;
+
+    /** Decades on the log scale (1us to 100ms) */
+    static constexpr float Decades = 5;
+
+    /**
+     * Map a duration onto the log scale
+     * @param micros duration in microseconds
+     * @return x position (px)
+     */
+    static float toX(float micros);
+
+    /** Append a solid rectangle (two triangles) */
+    void addRect(float left, float top, float width, float height, sf::Color color);
+
+    /** All the bars and lines */
+    sf::VertexArray m_vertices{sf::Triangles};
+};
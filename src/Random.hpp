@@ -0,0 +1,143 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Random number helpers shared by the game objects.
+The engine is MT19937, the same sequence as std::mt19937, but with its state in the
+open so snapshots can save it portably. The std distributions differ between standard
+libraries, so the helpers here are used instead, and a seed always plays out the same game.
+*/
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include "Serialize.hpp"
+
+namespace Game
+{
+
+/**
+ * Random number engine used by every game object.
+ * Produces exactly the same numbers as std::mt19937 from the same seed.
+ */
+class Rng
+{
+  public:
+    using result_type = std::uint32_t;
+
+    /** Number of 32 bit words of state */
+    static constexpr std::size_t StateSize = 624;
+
+    /** Seed the engine the same way as std::mt19937(seed) */
+    explicit Rng(std::uint32_t seed = 5489u)
+    {
+        m_state[0] = seed;
+        for (std::size_t i = 1; i < StateSize; i++)
+        {
+            const std::uint32_t prev = m_state[i - 1];
+            m_state[i]               = 1812433253u * (prev ^ (prev >> 30)) + static_cast<std::uint32_t>(i);
+        }
+        m_index = StateSize;
+    }
+
+    static constexpr result_type min()
+    {
+        return 0;
+    }
+
+    static constexpr result_type max()
+    {
+        return 0xFFFFFFFFu;
+    }
+
+    /** @return the next number of the sequence */
+    result_type operator()()
+    {
+        if (m_index >= StateSize)
+        {
+            this->twist();
+        }
+        std::uint32_t y = m_state[m_index++];
+        y ^= y >> 11;
+        y ^= (y << 7) & 0x9D2C5680u;
+        y ^= (y << 15) & 0xEFC60000u;
+        return y ^ (y >> 18);
+    }
+
+    /** Write the state words and the position in them (little endian, the same on every platform) */
+    void save(ByteWriter& out) const
+    {
+        for (std::uint32_t word : m_state)
+        {
+            out.le(word, 4);
+        }
+        out.le(m_index, 2);
+    }
+
+    /**
+     * Read back a state written by save()
+     * @throws std::runtime_error if the position is outside the state
+     */
+    void restore(ByteReader& in)
+    {
+        for (std::uint32_t& word : m_state)
+        {
+            word = static_cast<std::uint32_t>(in.le(4));
+        }
+        const std::uint64_t index = in.le(2);
+        if (index > StateSize)
+        {
+            in.fail("Invalid random engine state in");
+        }
+        m_index = static_cast<std::size_t>(index);
+    }
+
+  private:
+    /** Regenerate every state word at once */
+    void twist()
+    {
+        for (std::size_t i = 0; i < StateSize; i++)
+        {
+            const std::uint32_t y = (m_state[i] & 0x80000000u) | (m_state[(i + 1) % StateSize] & 0x7FFFFFFFu);
+            m_state[i]            = m_state[(i + 397) % StateSize] ^ (y >> 1) ^ ((y & 1u) != 0 ? 0x9908B0DFu : 0u);
+        }
+        m_index = 0;
+    }
+
+    std::array<std::uint32_t, StateSize> m_state{};
+
+    /** Next state word to temper, StateSize once they are all used */
+    std::size_t m_index = StateSize;
+};
+
+/**
+ * Uniform random integer in [0, n).
+ * Maps the 32 bit engine output onto the range with a multiply and shift.
+ * @param rng engine to draw from
+ * @param n number of possible values (> 0)
+ */
+inline std::uint32_t randomBelow(Rng& rng, std::uint32_t n)
+{
+    const auto bits = static_cast<std::uint64_t>(rng()) & 0xFFFFFFFFu;
+    return static_cast<std::uint32_t>((bits * n) >> 32);
+}
+
+/**
+ * Derive an independent seed for one of a game's random streams.
+ * Uses std::seed_seq, which is fully specified by the standard.
+ * @param seed the game seed
+ * @param stream which object the seed is for
+ */
+inline std::uint32_t streamSeed(std::uint32_t seed, std::uint32_t stream)
+{
+    std::seed_seq seq{seed, stream};
+    std::uint32_t out[1];
+    seq.generate(out, out + 1);
+    return out[0];
+}
+
+}; // end namespace Game
@@ -0,0 +1,312 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Defines the Renderer, drawing the World in batched quads.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <SFML/Graphics.hpp>
+
+#include "Renderer.hpp"
+#include "TextureManager.hpp"
+
+/**
+ * Construct the Renderer.
+ * All characters are on the same sprite-sheet.
+ */
+Renderer::Renderer() : m_sheet{TextureManager::GetTexture(TextureId::Sprites)}
+{
+}
+
+/** Draw all objects in the same order as the original game */
+void Renderer::draw(sf::RenderTarget& target, const World& world)
+{
+    this->drawSpider(target, world.getSpider());
+    this->drawMushrooms(target);
+    this->drawCentipede(target, world.getCentipede());
+    this->drawLasers(target, world.getLasers());
+    this->drawPlayer(target, world.getPlayer());
+    this->flush();
+}
+
+void Renderer::watch(World& world)
+{
+    world.setMushroomListener(this);
+}
+
+void Renderer::drawSpider(sf::RenderTarget& target, const Spider& spider)
+{
+    // only draw a living spider
+    if (spider.isAlive())
+    {
+        m_batch.add(target, m_sheet, spider.getPosition(), Spider::Size, Renderer::SpiderTexOffset);
+    }
+}
+
+/** Anything queued before the mushrooms must be drawn under them */
+void Renderer::drawMushrooms(sf::RenderTarget& target)
+{
+    m_batch.flush();
+    if (this->updateLayer())
+    {
+        target.draw(m_layerQuad, &m_shroomLayer.getTexture());
+    }
+    else
+    {
+        target.draw(m_shroomVertices, &m_sheet);
+    }
+}
+
+void Renderer::drawCentipede(sf::RenderTarget& target, const Centipede& centipede)
+{
+    const Segments& segments = centipede.getSegments();
+    for (std::size_t i = 0; i < segments.size(); i++)
+    {
+        if (segments.alive[i] != 0)
+        {
+            const sf::IntRect& rect = segments.head[i] != 0 ? Renderer::HeadTexOffset : Renderer::BodyTexOffset;
+            m_batch.add(target, m_sheet, segments.getPosition(i), Centipede::SegmentSize, rect, segments.flipped[i] != 0);
+        }
+    }
+}
+
+void Renderer::drawLasers(sf::RenderTarget& target, const World::Lasers& lasers)
+{
+    // skip inactive lasers
+    for (const auto& laser : lasers)
+    {
+        if (laser.isActive())
+        {
+            m_batch.add(target, m_sheet, laser.getPosition(), Laser::Size, Renderer::WhiteTexOffset, false, Renderer::LaserColor);
+        }
+    }
+}
+
+void Renderer::drawPlayer(sf::RenderTarget& target, const Player& player)
+{
+    m_batch.add(target, m_sheet, player.getPosition(), Player::Size, Renderer::PlayerTexOffset);
+}
+
+void Renderer::flush()
+{
+    m_batch.flush();
+}
+
+/** Place the two triangles of a mushroom, textured by its health */
+void Renderer::shroomChanged(const Shroom& shroom)
+{
+    const std::size_t first = shroom.getSlot() * Renderer::VerticesPerShroom;
+    if (first + Renderer::VerticesPerShroom > m_shroomVertices.getVertexCount())
+    {
+        // new slots start collapsed, they are filled in when used
+        m_shroomVertices.resize(first + Renderer::VerticesPerShroom);
+    }
+
+    const FloatRect collider = shroom.getCollider();
+    SpriteBatch::setQuad(&m_shroomVertices[first], {collider.left, collider.top, collider.width, collider.height},
+                         sf::FloatRect{Renderer::shroomTexture(shroom.getHealth())}, sf::Color::White);
+
+    // a damaged mushroom is already in its cells
+    this->forEachCell(collider, [&](std::size_t cell) {
+        Cell& slots = m_cells[cell];
+        if (std::find(slots.slots.begin(), slots.slots.begin() + slots.count, shroom.getSlot()) != slots.slots.begin() + slots.count)
+        {
+            return;
+        }
+        if (slots.count == Renderer::SlotsPerCell)
+        {
+            throw std::runtime_error("Too many mushrooms in a layer cell");
+        }
+        slots.slots[slots.count++] = shroom.getSlot();
+    });
+    this->markDirty(shroom);
+}
+
+/** Collapsing every vertex to one point makes zero-area triangles, which draw nothing */
+void Renderer::shroomRemoved(const Shroom& shroom)
+{
+    const std::size_t first = shroom.getSlot() * Renderer::VerticesPerShroom;
+    for (std::size_t i = 0; i < Renderer::VerticesPerShroom; i++)
+    {
+        m_shroomVertices[first + i] = sf::Vertex{};
+    }
+
+    // the order of a cell's slots doesn't matter, the last one fills the gap
+    this->forEachCell(shroom.getCollider(), [&](std::size_t cell) {
+        Cell&      slots = m_cells[cell];
+        const auto last  = slots.slots.begin() + slots.count;
+        const auto found = std::find(slots.slots.begin(), last, shroom.getSlot());
+        if (found != last)
+        {
+            *found = slots.slots[--slots.count];
+        }
+    });
+    this->markDirty(shroom);
+}
+
+/** The layer covers the game area too, a split centipede can leave mushrooms outside the starting bounds */
+void Renderer::shroomsReset(const MushroomManager& mushrooms)
+{
+    const FloatRect bounds = mushrooms.getBounds();
+    const float     left   = std::min(bounds.left, 0.f);
+    const float     top    = std::min(bounds.top, 0.f);
+    const float     right  = std::max(bounds.left + bounds.width, Game::GameSize.x);
+    const float     bottom = std::max(bounds.top + bounds.height, Game::GameSize.y);
+
+    m_columns   = static_cast<std::size_t>(std::ceil((right - left) / Renderer::CellSize));
+    m_rows      = static_cast<std::size_t>(std::ceil((bottom - top) / Renderer::CellSize));
+    m_layerArea = {left, top, static_cast<float>(m_columns) * Renderer::CellSize, static_cast<float>(m_rows) * Renderer::CellSize};
+
+    m_cells.assign(m_columns * m_rows, {});
+    m_cellDirty.assign(m_columns * m_rows, false);
+    m_dirtyCells.clear();
+    m_layerStale = true;
+
+    m_shroomVertices.clear();
+    m_shroomVertices.resize(mushrooms.getSlotCount() * Renderer::VerticesPerShroom);
+    for (const auto& shroom : mushrooms.getShrooms())
+    {
+        this->shroomChanged(shroom);
+    }
+}
+
+template <typename Visit> void Renderer::forEachCell(FloatRect rect, Visit visit) const
+{
+    // cells touched by the rectangle, edges that only touch a cell don't count
+    const float firstX = std::floor((rect.left - m_layerArea.left) / Renderer::CellSize);
+    const float firstY = std::floor((rect.top - m_layerArea.top) / Renderer::CellSize);
+    const float lastX  = std::ceil((rect.left + rect.width - m_layerArea.left) / Renderer::CellSize) - 1;
+    const float lastY  = std::ceil((rect.top + rect.height - m_layerArea.top) / Renderer::CellSize) - 1;
+
+    const float maxX = static_cast<float>(m_columns) - 1;
+    const float maxY = static_cast<float>(m_rows) - 1;
+    for (float y = std::max(firstY, 0.f); y <= std::min(lastY, maxY); y++)
+    {
+        for (float x = std::max(firstX, 0.f); x <= std::min(lastX, maxX); x++)
+        {
+            visit(static_cast<std::size_t>(y) * m_columns + static_cast<std::size_t>(x));
+        }
+    }
+}
+
+void Renderer::markDirty(const Shroom& shroom)
+{
+    // a full rebuild is coming anyway
+    if (m_layerStale)
+    {
+        return;
+    }
+
+    this->forEachCell(shroom.getCollider(), [&](std::size_t cell) {
+        if (!m_cellDirty[cell])
+        {
+            m_cellDirty[cell] = true;
+            m_dirtyCells.push_back(cell);
+        }
+    });
+}
+
+/**
+ * Each dirty cell is cleared (replacing its pixels, blending would keep them), then every
+ * mushroom overlapping it is drawn again, clipped to the cell so its neighbours are untouched.
+ */
+bool Renderer::updateLayer()
+{
+    if (m_layerStale)
+    {
+        this->rebuildLayer();
+    }
+    if (!m_layerReady || m_dirtyCells.empty())
+    {
+        m_dirtyCells.clear();
+        return m_layerReady;
+    }
+
+    m_clearVertices.clear();
+    m_patchVertices.clear();
+    for (const std::size_t cell : m_dirtyCells)
+    {
+        m_cellDirty[cell] = false;
+
+        const sf::FloatRect area{m_layerArea.left + static_cast<float>(cell % m_columns) * Renderer::CellSize,
+                                 m_layerArea.top + static_cast<float>(cell / m_columns) * Renderer::CellSize, Renderer::CellSize, Renderer::CellSize};
+        SpriteBatch::appendQuad(m_clearVertices, area, {}, sf::Color::Transparent);
+
+        const Cell& slots = m_cells[cell];
+        for (std::uint32_t i = 0; i < slots.count; i++)
+        {
+            const std::uint32_t slot = slots.slots[i];
+            // the first and third vertices are opposite corners of the mushroom
+            const sf::Vertex* quad = &m_shroomVertices[slot * Renderer::VerticesPerShroom];
+            const sf::FloatRect shroom{quad[0].position, quad[2].position - quad[0].position};
+            const sf::FloatRect texture{quad[0].texCoords, quad[2].texCoords - quad[0].texCoords};
+
+            sf::FloatRect clipped;
+            if (!shroom.intersects(area, clipped))
+            {
+                continue;
+            }
+            const float scaleX = texture.width / shroom.width;
+            const float scaleY = texture.height / shroom.height;
+            SpriteBatch::appendQuad(m_patchVertices, clipped,
+                       {texture.left + (clipped.left - shroom.left) * scaleX, texture.top + (clipped.top - shroom.top) * scaleY, clipped.width * scaleX,
+                        clipped.height * scaleY},
+                       sf::Color::White);
+        }
+    }
+    m_dirtyCells.clear();
+
+    m_shroomLayer.draw(m_clearVertices, sf::RenderStates{sf::BlendNone});
+    m_shroomLayer.draw(m_patchVertices, &m_sheet);
+    m_shroomLayer.display();
+    return true;
+}
+
+/** Layers larger than the GPU supports (huge benchmark scenes) fall back to drawing the vertices */
+void Renderer::rebuildLayer()
+{
+    m_layerStale = false;
+    m_dirtyCells.clear();
+    m_cellDirty.assign(m_cellDirty.size(), false);
+
+    const auto width  = static_cast<unsigned>(m_layerArea.width);
+    const auto height = static_cast<unsigned>(m_layerArea.height);
+    const auto limit  = sf::Texture::getMaximumSize();
+    m_layerReady      = width > 0 && height > 0 && width <= limit && height <= limit && m_shroomLayer.create(width, height);
+    if (!m_layerReady)
+    {
+        return;
+    }
+
+    const sf::FloatRect area{m_layerArea.left, m_layerArea.top, m_layerArea.width, m_layerArea.height};
+    m_layerQuad.clear();
+    SpriteBatch::appendQuad(m_layerQuad, area, {0, 0, m_layerArea.width, m_layerArea.height}, sf::Color::White);
+
+    m_shroomLayer.setView(sf::View{area});
+    m_shroomLayer.clear(sf::Color::Transparent);
+    m_shroomLayer.draw(m_shroomVertices, &m_sheet);
+    m_shroomLayer.display();
+}
+
+/** Mushrooms have 3 levels of damage before being destroyed */
+const sf::IntRect& Renderer::shroomTexture(int health)
+{
+    switch (health)
+    {
+    case 3:
+        return Renderer::Damage3TexOffset;
+    case 2:
+        return Renderer::Damage2TexOffset;
+    case 1:
+        return Renderer::Damage1TexOffset;
+    default:
+        return Renderer::FullTexOffset;
+    }
+}
@@ -0,0 +1,182 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Declare the Renderer, the SFML front end that draws a World.
+All the sprite-sheet knowledge lives here, the World only knows about positions and state.
+*/
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "Settings.hpp"
+#include "SpriteBatch.hpp"
+#include "World.hpp"
+
+/**
+ * The Renderer draws the game objects of a World as quads from the sprite-sheet.
+ * Everything is queued in a SpriteBatch in draw order, so a whole frame takes three
+ * draw calls (spider, mushrooms, then everything else) however many objects there are.
+ * Lasers are solid quads, sampling a single white texel of the sheet.
+ *
+ * Mushrooms are handled apart, there can be a great many of them and they rarely change.
+ * The Renderer listens to the mushrooms, and keeps one vertex array (two triangles per
+ * mushroom slot) patched when a mushroom is placed, damaged or destroyed.
+ * The mushrooms are drawn once into a layer texture, and each change only marks the
+ * grid cells it touches. A frame redraws the dirty cells, then composites the layer with
+ * one quad, so the cost follows the number of changes rather than the number of mushrooms.
+ * When the layer would be too large for a texture, the vertex array is drawn directly.
+ */
+class Renderer : public MushroomListener
+{
+  public:
+    /** Construct a new Renderer, all sprites share the same sprite-sheet */
+    Renderer();
+
+    /**
+     * Draw every game object in the World to the target.
+     * @param target the window or texture to draw to
+     * @param world the game state to draw
+     */
+    void draw(sf::RenderTarget& target, const World& world);
+
+    /** Keep the mushroom vertices in sync with `world` (call for every new World before drawing it) */
+    void watch(World& world);
+
+    // Each object type can also be drawn on its own, the batched quads are drawn by flush()
+
+    /** Queue the spider (if alive) */
+    void drawSpider(sf::RenderTarget& target, const Spider& spider);
+
+    /** Draw every mushroom of the watched mushrooms, in one draw call (after flushing the queued quads and any dirty cells) */
+    void drawMushrooms(sf::RenderTarget& target);
+
+    /** Queue every centipede segment */
+    void drawCentipede(sf::RenderTarget& target, const Centipede& centipede);
+
+    /** Queue every active laser */
+    void drawLasers(sf::RenderTarget& target, const World::Lasers& lasers);
+
+    /** Queue the player starship */
+    void drawPlayer(sf::RenderTarget& target, const Player& player);
+
+    /** Draw every queued quad */
+    void flush();
+
+    /** Update the vertices of a placed or damaged mushroom (implements MushroomListener) */
+    void shroomChanged(const Shroom& shroom) override;
+
+    /** Hide the vertices of a destroyed mushroom (implements MushroomListener) */
+    void shroomRemoved(const Shroom& shroom) override;
+
+    /** Rebuild every mushroom's vertices, and the layer on the next draw (implements MushroomListener) */
+    void shroomsReset(const MushroomManager& mushrooms) override;
+
+  private:
+    // Texture positions in the sprite-sheet
+    static inline const sf::IntRect PlayerTexOffset{12, 171, 7, 8};
+    static inline const sf::IntRect SpiderTexOffset{8, 75, 15, 8};
+    static inline const sf::IntRect HeadTexOffset{12, 43, 8, 8};   // head texture
+    static inline const sf::IntRect BodyTexOffset{116, 251, 8, 8}; // body texture
+
+    // Constant regions for mushroom textures in the sprite-sheet
+    static inline const sf::IntRect FullTexOffset{104, 107, 8, 8};
+    static inline const sf::IntRect Damage1TexOffset{152, 107, 8, 8};
+    static inline const sf::IntRect Damage2TexOffset{136, 107, 8, 8};
+    static inline const sf::IntRect Damage3TexOffset{120, 107, 8, 8};
+
+    /** A single opaque white texel, stretched over every laser */
+    static inline const sf::IntRect WhiteTexOffset{87, 6, 1, 1};
+
+    /** Color of all lasers (Red) */
+    static inline const sf::Color LaserColor = sf::Color::Red;
+
+    /** Size of the cells redrawn in the mushroom layer, one grid square (px) */
+    static constexpr float CellSize = Game::GridSize;
+
+    /**
+     * Pick the mushroom texture for a health level
+     * @param health remaining health of a mushroom
+     * @return the texture rect to use
+     */
+    static const sf::IntRect& shroomTexture(int health);
+
+    /** The shared sprite-sheet */
+    const sf::Texture& m_sheet;
+
+    /** Vertices per mushroom slot (two triangles) */
+    static constexpr std::size_t VerticesPerShroom = SpriteBatch::QuadVertices;
+
+    /** Every mushroom slot, free slots are collapsed to a point so nothing is drawn */
+    sf::VertexArray m_shroomVertices{sf::Triangles};
+
+    /** Every mushroom drawn once, in world coordinates over m_layerArea */
+    sf::RenderTexture m_shroomLayer;
+
+    /** Area of the world covered by the layer (the mushroom bounds and the game area) */
+    FloatRect m_layerArea;
+
+    /** Quad that composites the layer onto the target */
+    sf::VertexArray m_layerQuad{sf::Triangles};
+
+    /** Number of cell columns and rows in the layer */
+    std::size_t m_columns = 0;
+    std::size_t m_rows    = 0;
+
+    /**
+     * Most mushrooms overlapping one cell. Cells are as large as the mushroom grid and each
+     * grid cell holds at most one mushroom, so a cell overlaps at most 4 of them.
+     */
+    static constexpr std::size_t SlotsPerCell = 4;
+
+    /** Mushroom slots overlapping a cell, stored inline */
+    struct Cell
+    {
+        std::array<std::uint32_t, SlotsPerCell> slots{};
+        std::uint32_t                           count = 0;
+    };
+
+    /** Slots of each cell (row-major), in one flat array */
+    std::vector<Cell> m_cells;
+
+    /** Which cells must be redrawn, and their indices */
+    std::vector<bool>        m_cellDirty;
+    std::vector<std::size_t> m_dirtyCells;
+
+    /** Cleared cells, and the mushrooms clipped to them, drawn on the next frame */
+    sf::VertexArray m_clearVertices{sf::Triangles};
+    sf::VertexArray m_patchVertices{sf::Triangles};
+
+    /** The whole layer must be rebuilt (after a reset) */
+    bool m_layerStale = true;
+
+    /** The layer texture exists, otherwise the mushroom vertices are drawn directly */
+    bool m_layerReady = false;
+
+    /**
+     * Call `visit(cell index)` for every cell of the layer that overlaps `rect`
+     * @param rect area in world coordinates (clamped to the layer)
+     */
+    template <typename Visit> void forEachCell(FloatRect rect, Visit visit) const;
+
+    /** Mark every cell a mushroom overlaps to be redrawn */
+    void markDirty(const Shroom& shroom);
+
+    /**
+     * Bring the layer up to date: a full rebuild if stale, otherwise redraw the dirty cells
+     * @return false if there is no layer (draw the mushroom vertices instead)
+     */
+    bool updateLayer();
+
+    /** (Re)create the layer texture and draw every mushroom into it */
+    void rebuildLayer();
+
+    /** Quads of every object except mushrooms, in draw order */
+    SpriteBatch m_batch;
+};
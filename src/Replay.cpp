@@ -0,0 +1,170 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Replay recorder definition, and the binary file format.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Replay.hpp"
+#include "Serialize.hpp"
+
+namespace
+{
+
+/** File signature */
+constexpr char Magic[4] = {'C', 'P', 'R', 'P'};
+
+/** Bits of each control in a packed byte */
+enum Bits : std::uint8_t { Up = 1 << 0, Down = 1 << 1, Left = 1 << 2, Right = 1 << 3, Fire = 1 << 4 };
+
+/** Every bit a packed byte may have set */
+constexpr std::uint8_t AllBits = Up | Down | Left | Right | Fire;
+
+/** One run of the file: the same controls for `length` ticks */
+struct Run
+{
+    std::uint8_t  bits;
+    std::uint64_t length;
+};
+
+} // namespace
+
+Replay::Replay(std::uint32_t seed) : m_seed{seed}
+{
+}
+
+void Replay::record(const Input& input)
+{
+    m_ticks.push_back(Replay::pack(input));
+}
+
+Input Replay::at(std::uint64_t tick) const
+{
+    return Replay::unpack(m_ticks[tick]);
+}
+
+std::uint32_t Replay::getSeed() const
+{
+    return m_seed;
+}
+
+std::uint64_t Replay::getTicks() const
+{
+    return m_ticks.size();
+}
+
+/** Encode the header and run-length encoded controls, then write them in one go */
+void Replay::save(const std::string& path) const
+{
+    if (m_ticks.size() > Replay::MaxTicks)
+    {
+        throw std::runtime_error("Replay too long to save: " + path);
+    }
+
+    ByteWriter out;
+    out.raw(Magic, sizeof(Magic));
+    out.byte(Replay::Version);
+    out.le(m_seed, 4);
+    out.le(m_ticks.size(), 8);
+
+    // controls usually stay the same for many ticks in a row
+    for (std::size_t i = 0; i < m_ticks.size();)
+    {
+        std::size_t run = 1;
+        while (i + run < m_ticks.size() && m_ticks[i + run] == m_ticks[i])
+        {
+            run++;
+        }
+        out.byte(m_ticks[i]);
+        out.varint(run);
+        i += run;
+    }
+
+    writeFile(path, out.data(), "replay file: " + path);
+}
+
+/** Read the whole file, check the header and every run, then expand the runs */
+Replay Replay::load(const std::string& path)
+{
+    const std::string               what = "replay file: " + path;
+    const std::vector<std::uint8_t> data = readFile(path, what);
+
+    ByteReader in{data, what};
+    for (char c : Magic)
+    {
+        if (in.byte() != static_cast<std::uint8_t>(c))
+        {
+            in.fail("Not a");
+        }
+    }
+    if (in.byte() != Replay::Version)
+    {
+        in.fail("Unsupported version of");
+    }
+
+    Replay replay{static_cast<std::uint32_t>(in.le(4))};
+    const std::uint64_t ticks = in.le(8);
+    if (ticks > Replay::MaxTicks)
+    {
+        in.fail("Too many ticks in");
+    }
+
+    // every run is checked before the ticks are expanded, so a corrupt file allocates nothing large
+    std::vector<Run> runs;
+    std::uint64_t    total = 0;
+    while (total < ticks)
+    {
+        const std::uint8_t bits = in.byte();
+        if ((bits & ~AllBits) != 0)
+        {
+            in.fail("Unknown controls in");
+        }
+        const std::uint64_t length = in.varint();
+        if (length == 0 || length > ticks - total)
+        {
+            in.fail("Invalid run length in");
+        }
+        runs.push_back({bits, length});
+        total += length;
+    }
+    if (!in.atEnd())
+    {
+        in.fail("Trailing data in");
+    }
+
+    replay.m_ticks.reserve(static_cast<std::size_t>(ticks));
+    for (const Run& run : runs)
+    {
+        replay.m_ticks.insert(replay.m_ticks.end(), static_cast<std::size_t>(run.length), run.bits);
+    }
+    return replay;
+}
+
+std::uint8_t Replay::pack(const Input& input)
+{
+    std::uint8_t bits = 0;
+    bits |= input.up ? Bits::Up : 0;
+    bits |= input.down ? Bits::Down : 0;
+    bits |= input.left ? Bits::Left : 0;
+    bits |= input.right ? Bits::Right : 0;
+    bits |= input.fire ? Bits::Fire : 0;
+    return bits;
+}
+
+Input Replay::unpack(std::uint8_t bits)
+{
+    Input input;
+    input.up    = (bits & Bits::Up) != 0;
+    input.down  = (bits & Bits::Down) != 0;
+    input.left  = (bits & Bits::Left) != 0;
+    input.right = (bits & Bits::Right) != 0;
+    input.fire  = (bits & Bits::Fire) != 0;
+    return input;
+}
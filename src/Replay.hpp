@@ -0,0 +1,88 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Declare the Replay recorder. A replay is the game seed plus the controls of every tick,
+which is all that is needed to play a World back exactly.
+*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Input.hpp"
+
+/**
+ * A recording of one game.
+ *
+ * In memory the controls are one packed byte per tick, so any tick can be looked up directly.
+ * On disk consecutive ticks with the same controls are run-length encoded:
+ *
+ *     "CPRP"        magic (4 bytes)
+ *     version       u8
+ *     seed          u32, little endian
+ *     tick count    u64, little endian, at most MaxTicks
+ *     runs...       u8 controls, followed by the run length as a LEB128 varint
+ *
+ * The runs must add up to exactly the tick count, with nothing after the last one.
+ */
+class Replay
+{
+  public:
+    /** Current version of the file format */
+    static constexpr std::uint8_t Version = 1;
+
+    /**
+     * Longest replay that can be saved or loaded: about 52 days at 60 ticks per second (256 MiB in memory).
+     * A single run can claim any length in a few bytes, so the count is checked before anything is allocated.
+     */
+    static constexpr std::uint64_t MaxTicks = std::uint64_t{1} << 28;
+
+    /**
+     * Start an empty recording
+     * @param seed the seed of the recorded World
+     */
+    explicit Replay(std::uint32_t seed);
+
+    /** Append the controls of the next tick */
+    void record(const Input& input);
+
+    /**
+     * Get the controls of a recorded tick
+     * @param tick index of the tick, must be less than getTicks()
+     */
+    Input at(std::uint64_t tick) const;
+
+    /** @return the seed of the recorded World */
+    std::uint32_t getSeed() const;
+
+    /** @return the number of recorded ticks */
+    std::uint64_t getTicks() const;
+
+    /**
+     * Write the replay to a file
+     * @throws std::runtime_error if the file can't be written, or the replay is longer than MaxTicks
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * Read a replay from a file
+     * @throws std::runtime_error if the file is missing or not a valid replay
+     */
+    static Replay load(const std::string& path);
+
+  private:
+    /** Pack every control into one bit of a byte */
+    static std::uint8_t pack(const Input& input);
+
+    /** Unpack the controls from a byte */
+    static Input unpack(std::uint8_t bits);
+
+    /** Seed of the recorded World */
+    std::uint32_t m_seed;
+
+    /** Packed controls, one byte per tick */
+    std::vector<std::uint8_t> m_ticks;
+};
@@ -0,0 +1,174 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Defines the Runner and its work stealing worker loop.
+*/
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Runner.hpp"
+#include "World.hpp"
+
+namespace
+{
+
+/** Play a single game in a fresh World */
+GameResult play(std::uint32_t seed, std::uint64_t maxTicks, const InputScript& script)
+{
+    World world{seed};
+
+    GameResult result;
+    result.seed       = seed;
+    result.ticks      = world.simulate(maxTicks, script);
+    result.playerDied = world.isOver();
+    result.livesLeft  = world.getPlayer().getLives();
+    result.mushrooms  = world.getMushrooms().getShrooms().size();
+    result.segments   = world.getCentipede().getSegmentCount();
+    return result;
+}
+
+/** Joins every started thread when it goes out of scope, even while an exception unwinds */
+struct JoinAll
+{
+    std::vector<std::thread>& pool;
+
+    ~JoinAll()
+    {
+        for (auto& thread : pool)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+    }
+};
+
+} // namespace
+
+/** Use every hardware thread when no count is given */
+Runner::Runner(unsigned threads) : m_threads{threads}
+{
+    if (m_threads == 0)
+    {
+        m_threads = std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency() may not be known
+    if (m_threads == 0)
+    {
+        m_threads = 1;
+    }
+}
+
+/**
+ * Deal the games out to the workers round-robin, then let them balance by stealing.
+ * No games are added once the workers start, so a worker can quit as soon as every queue is empty.
+ * An exception must not escape a thread (that calls std::terminate), so the first one is kept,
+ * every worker stops at its next game, and it is rethrown once they have all been joined.
+ */
+std::vector<GameResult> Runner::run(std::size_t worlds, std::uint64_t maxTicks, const InputScript& script, std::uint32_t firstSeed)
+{
+    std::vector<GameResult> results(worlds);
+    std::vector<Queue>      queues(m_threads);
+
+    for (std::size_t i = 0; i < worlds; i++)
+    {
+        queues[i % m_threads].games.push_back(i);
+    }
+
+    std::atomic<bool>  failed{false};
+    std::mutex         errorMutex;
+    std::exception_ptr error;
+
+    auto fail = [&](std::exception_ptr caught) {
+        std::lock_guard<std::mutex> lock{errorMutex};
+        if (!error)
+        {
+            error = caught;
+        }
+        failed = true;
+    };
+
+    auto worker = [&](std::size_t self) {
+        try
+        {
+            std::size_t game = 0;
+            while (!failed && Runner::nextGame(queues, self, game))
+            {
+                // only this worker ever writes this slot
+                results[game] = play(firstSeed + static_cast<std::uint32_t>(game), maxTicks, script);
+            }
+        }
+        catch (...)
+        {
+            fail(std::current_exception());
+        }
+    };
+
+    {
+        std::vector<std::thread> pool;
+        JoinAll                  joinAll{pool};
+        pool.reserve(m_threads);
+        try
+        {
+            for (std::size_t i = 0; i < m_threads; i++)
+            {
+                pool.emplace_back(worker, i);
+            }
+        }
+        catch (...)
+        {
+            // the threads already started are stopped and joined by joinAll
+            fail(std::current_exception());
+        }
+        // joining publishes every result (and the error) to this thread
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
+
+bool Runner::nextGame(std::vector<Queue>& queues, std::size_t self, std::size_t& game)
+{
+    // newest game from our own queue first
+    {
+        auto&                       own = queues[self];
+        std::lock_guard<std::mutex> lock{own.mutex};
+        if (!own.games.empty())
+        {
+            game = own.games.back();
+            own.games.pop_back();
+            return true;
+        }
+    }
+
+    // otherwise steal the oldest game from the next busy worker
+    for (std::size_t i = 1; i < queues.size(); i++)
+    {
+        auto&                       victim = queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock{victim.mutex};
+        if (!victim.games.empty())
+        {
+            game = victim.games.front();
+            victim.games.pop_front();
+            return true;
+        }
+    }
+
+    // nothing left anywhere
+    return false;
+}
+
+unsigned Runner::getThreads() const
+{
+    return m_threads;
+}
@@ -0,0 +1,95 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Declare the Runner, which plays many independent headless games at once.
+Every game gets its own World, and games are balanced across threads by work stealing.
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "Input.hpp"
+
+/** The outcome of one headless game */
+struct GameResult
+{
+    /** Seed of the game, replays it exactly with the same script */
+    std::uint32_t seed = 0;
+
+    /** Ticks simulated before the game ended */
+    std::uint64_t ticks = 0;
+
+    /** True if the player died, false if the game hit the tick limit */
+    bool playerDied = false;
+
+    /** Lives remaining at the end */
+    int livesLeft = 0;
+
+    /** Mushrooms remaining at the end */
+    std::size_t mushrooms = 0;
+
+    /** Centipede segments remaining at the end */
+    std::size_t segments = 0;
+};
+
+/**
+ * Runs N independent Worlds across a pool of worker threads.
+ *
+ * Each worker owns a queue of games. It plays its own games newest-first,
+ * and when it runs out it steals the oldest game from another worker.
+ * Games end at very different times (when the player dies), so this keeps
+ * every thread busy until the last few games.
+ *
+ * Results are written straight into a pre-sized vector. Each slot is written
+ * by exactly one worker, so no locking is needed to collect them.
+ */
+class Runner
+{
+  public:
+    /**
+     * Construct a new Runner
+     * @param threads number of worker threads (0 uses every hardware thread)
+     */
+    Runner(unsigned threads = 0);
+
+    /**
+     * Play `worlds` games to completion, blocking until all are finished.
+     *
+     * @param worlds number of independent games
+     * @param maxTicks tick limit for every game
+     * @param script input source for every game, must be safe to call from several threads at once
+     * @param firstSeed game `i` is seeded with `firstSeed + i`
+     * @return one result per game, in game order
+     * @throws the first exception thrown by any game (or by starting a thread), once every worker has stopped
+     */
+    std::vector<GameResult> run(std::size_t worlds, std::uint64_t maxTicks, const InputScript& script, std::uint32_t firstSeed);
+
+    /** @return the number of worker threads */
+    unsigned getThreads() const;
+
+  private:
+    /** A worker's queue of game indices */
+    struct Queue
+    {
+        std::mutex              mutex;
+        std::deque<std::size_t> games;
+    };
+
+    /**
+     * Take the next game for a worker, from its own queue or stolen from another.
+     * @param queues one queue per worker, local to a single run() so concurrent runs never share them
+     * @param self index of the worker asking
+     * @param game set to the index of the game to play
+     * @return false when every queue is empty
+     */
+    static bool nextGame(std::vector<Queue>& queues, std::size_t self, std::size_t& game);
+
+    /** Number of worker threads */
+    unsigned m_threads;
+};
@@ -0,0 +1,215 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Binary encoding definitions.
+*/
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#include "Serialize.hpp"
+
+static_assert(sizeof(float) == 4 && sizeof(double) == 8, "floats are stored as their IEEE-754 bits");
+
+void ByteWriter::byte(std::uint8_t value)
+{
+    m_data.push_back(value);
+}
+
+void ByteWriter::le(std::uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        m_data.push_back(static_cast<std::uint8_t>(value & 0xFF));
+        value >>= 8;
+    }
+}
+
+void ByteWriter::varint(std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_data.push_back(static_cast<std::uint8_t>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    m_data.push_back(static_cast<std::uint8_t>(value));
+}
+
+void ByteWriter::flag(bool value)
+{
+    this->byte(value ? 1 : 0);
+}
+
+void ByteWriter::f32(float value)
+{
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    this->le(bits, 4);
+}
+
+void ByteWriter::f64(double value)
+{
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    this->le(bits, 8);
+}
+
+void ByteWriter::vec(Vec2f value)
+{
+    this->f32(value.x);
+    this->f32(value.y);
+}
+
+void ByteWriter::raw(const void* data, std::size_t size)
+{
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    m_data.insert(m_data.end(), bytes, bytes + size);
+}
+
+const std::vector<std::uint8_t>& ByteWriter::data() const
+{
+    return m_data;
+}
+
+ByteReader::ByteReader(const std::vector<std::uint8_t>& data, std::string what) : m_data{data}, m_what{std::move(what)}
+{
+}
+
+std::uint8_t ByteReader::byte()
+{
+    if (m_pos >= m_data.size())
+    {
+        this->fail("Truncated");
+    }
+    return m_data[m_pos++];
+}
+
+std::uint8_t ByteReader::byteBelow(std::uint8_t limit)
+{
+    const std::uint8_t value = this->byte();
+    if (value >= limit)
+    {
+        this->fail("Invalid value in");
+    }
+    return value;
+}
+
+std::uint64_t ByteReader::le(int bytes)
+{
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; i++)
+    {
+        value |= static_cast<std::uint64_t>(this->byte()) << (8 * i);
+    }
+    return value;
+}
+
+std::uint64_t ByteReader::varint()
+{
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        const std::uint8_t b = this->byte();
+        value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    this->fail("Invalid varint in");
+}
+
+bool ByteReader::flag()
+{
+    return this->byteBelow(2) != 0;
+}
+
+float ByteReader::f32()
+{
+    const auto bits  = static_cast<std::uint32_t>(this->le(4));
+    float      value = 0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+double ByteReader::f64()
+{
+    const std::uint64_t bits  = this->le(8);
+    double              value = 0;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+Vec2f ByteReader::vec()
+{
+    Vec2f value;
+    value.x = this->f32();
+    value.y = this->f32();
+    return value;
+}
+
+/** Written as negated comparisons, which are true for NaN */
+double ByteReader::f64Within(double min, double max)
+{
+    const double value = this->f64();
+    if (!(value >= min && value <= max))
+    {
+        this->fail("Value out of range in");
+    }
+    return value;
+}
+
+Vec2f ByteReader::vecWithin(const FloatRect& area)
+{
+    const Vec2f value = this->vec();
+    if (!(value.x >= area.left && value.x <= area.left + area.width && value.y >= area.top && value.y <= area.top + area.height))
+    {
+        this->fail("Position out of range in");
+    }
+    return value;
+}
+
+void ByteReader::raw(void* data, std::size_t size)
+{
+    if (size > m_data.size() - m_pos)
+    {
+        this->fail("Truncated");
+    }
+    std::memcpy(data, m_data.data() + m_pos, size);
+    m_pos += size;
+}
+
+bool ByteReader::atEnd() const
+{
+    return m_pos == m_data.size();
+}
+
+void ByteReader::fail(const std::string& problem) const
+{
+    throw std::runtime_error(problem + " " + m_what);
+}
+
+std::vector<std::uint8_t> readFile(const std::string& path, const std::string& what)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+    {
+        throw std::runtime_error("Could not open " + what);
+    }
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::string& path, const std::vector<std::uint8_t>& data, const std::string& what)
+{
+    std::ofstream file{path, std::ios::binary};
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file)
+    {
+        throw std::runtime_error("Could not write " + what);
+    }
+}
@@ -0,0 +1,129 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Little-endian binary encoding shared by the replay and snapshot formats.
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Geometry.hpp"
+
+/** Appends values to a growing byte buffer */
+class ByteWriter
+{
+  public:
+    /** Append a single byte */
+    void byte(std::uint8_t value);
+
+    /** Append `bytes` bytes of an unsigned value, least significant first */
+    void le(std::uint64_t value, int bytes);
+
+    /** Append a value as a LEB128 varint (7 bits per byte, high bit means more follow) */
+    void varint(std::uint64_t value);
+
+    /** Append a bool as one byte */
+    void flag(bool value);
+
+    /** Append the bits of a float (exact, 4 bytes) */
+    void f32(float value);
+
+    /** Append the bits of a double (exact, 8 bytes) */
+    void f64(double value);
+
+    /** Append both coordinates of a vector */
+    void vec(Vec2f value);
+
+    /** Append raw memory as-is */
+    void raw(const void* data, std::size_t size);
+
+    /** @return everything written so far */
+    const std::vector<std::uint8_t>& data() const;
+
+  private:
+    std::vector<std::uint8_t> m_data;
+};
+
+/** Reads values back from a buffer, throwing std::runtime_error on truncated or invalid data */
+class ByteReader
+{
+  public:
+    /**
+     * Construct a new ByteReader
+     * @param data the buffer to read, must outlive the reader
+     * @param what describes the data in error messages, e.g. "replay file: name.rpl"
+     */
+    ByteReader(const std::vector<std::uint8_t>& data, std::string what);
+
+    /** Read a single byte */
+    std::uint8_t byte();
+
+    /**
+     * Read a byte that must be less than `limit` (e.g. an enum)
+     * @throws std::runtime_error if it is not
+     */
+    std::uint8_t byteBelow(std::uint8_t limit);
+
+    /** Read `bytes` bytes of an unsigned value, least significant first */
+    std::uint64_t le(int bytes);
+
+    /** Read a LEB128 varint */
+    std::uint64_t varint();
+
+    /** Read a bool */
+    bool flag();
+
+    /** Read the bits of a float */
+    float f32();
+
+    /** Read the bits of a double */
+    double f64();
+
+    /** Read both coordinates of a vector */
+    Vec2f vec();
+
+    /**
+     * Read a double that must be within [min, max] (so never NaN or infinite)
+     * @throws std::runtime_error if it is not
+     */
+    double f64Within(double min, double max);
+
+    /**
+     * Read a vector that must be inside `area`, edges included (so never NaN or infinite)
+     * @throws std::runtime_error if it is not
+     */
+    Vec2f vecWithin(const FloatRect& area);
+
+    /** Read raw memory as-is */
+    void raw(void* data, std::size_t size);
+
+    /** @return true once every byte has been read */
+    bool atEnd() const;
+
+    /** Throw a std::runtime_error saying the data is invalid */
+    [[noreturn]] void fail(const std::string& problem) const;
+
+  private:
+    const std::vector<std::uint8_t>& m_data;
+    std::string                      m_what;
+    std::size_t                      m_pos = 0;
+};
+
+/**
+ * Read a whole binary file
+ * @param what describes the file in error messages
+ * @throws std::runtime_error if the file can't be opened
+ */
+std::vector<std::uint8_t> readFile(const std::string& path, const std::string& what);
+
+/**
+ * Write a whole binary file, replacing it
+ * @param what describes the file in error messages
+ * @throws std::runtime_error if the file can't be written
+ */
+void writeFile(const std::string& path, const std::vector<std::uint8_t>& data, const std::string& what);
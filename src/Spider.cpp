@@ -6,21 +6,15 @@ Description:
 Spider class definition and implementation
 */
 
-#include <random>
-
-#include "SFML/Graphics.hpp"
+#include <array>
+#include <cstdint>
 
 #include "Spider.hpp"
-#include "TextureManager.hpp"
 
-/** Construction and set up the inherited Sprite properties */
-Spider::Spider(sf::FloatRect bounds) : m_rng{std::random_device{}()}
+/** Construction shrinks the bounds to account for the centered origin */
+Spider::Spider(FloatRect bounds, std::uint32_t seed) : m_rng{seed}
 {
-    m_sprite.setTexture(TextureManager::GetTexture("graphics/sprites.png"));
-    m_sprite.setTextureRect(Spider::SpiderTexOffset);
-
-    const auto& size = m_sprite.getLocalBounds().getSize();
-    m_sprite.setOrigin(size.x / 2.f, size.y / 2.f);
+    const Vec2f size = Spider::Size;
 
     bounds.left += size.x / 2.f;
     bounds.top += size.y / 2.f;
@@ -34,26 +28,18 @@ Spider::Spider(sf::FloatRect bounds) : m_rng{std::random_device{}()}
 void Spider::spawn()
 {
     // start on the top left of it's bounds.
-    m_sprite.setPosition(m_bounds.left, m_bounds.top);
+    this->moveTo({m_bounds.left, m_bounds.top});
     m_direction = Moving::UpRight;
     m_alive     = true;
 }
 
-void Spider::draw(sf::RenderTarget& target, sf::RenderStates states) const
-{
-    if (m_alive)
-    {
-        target.draw(m_sprite, states);
-    }
-}
-
 void Spider::update(float deltaTime)
 {
     // if currently inactive, increment timer and don't move around
     if (!m_alive)
     {
         m_respawnTimer += deltaTime;
-        if (m_respawnTimer >= m_respawnDuration)
+        if (m_respawnTimer >= Spider::RespawnDuration)
         {
             this->spawn();
             m_respawnTimer = 0;
@@ -62,45 +48,48 @@ void Spider::update(float deltaTime)
     }
 
     float distance = Spider::Speed * deltaTime;
+    Vec2f step;
     switch (m_direction)
     {
     case Moving::Up:
-        m_sprite.move(0.0, -distance);
+        step = {0.0, -distance};
         break;
     case Moving::Down:
-        m_sprite.move(0.0, distance);
+        step = {0.0, distance};
         break;
     case Moving::DownLeft:
-        m_sprite.move(-distance, distance);
+        step = {-distance, distance};
         break;
     case Moving::DownRight:
-        m_sprite.move(distance, distance);
+        step = {distance, distance};
         break;
     case Moving::UpLeft:
-        m_sprite.move(-distance, -distance);
+        step = {-distance, -distance};
         break;
     case Moving::UpRight:
-        m_sprite.move(distance, -distance);
+        step = {distance, -distance};
         break;
     }
+    this->moveTo(m_position + step);
 
-    if (m_sprite.getPosition().x >= m_bounds.left + m_bounds.width)
+    if (m_position.x >= m_bounds.left + m_bounds.width)
     {
         m_canMoveLeft = true;
     }
 
     m_moveTimer += deltaTime;
     // time to pick a new direction?
-    if (m_moveTimer >= m_moveDuration)
+    if (m_moveTimer >= Spider::MoveDuration)
     {
-        // Construct the possible next directions
-        std::vector<Moving> allowedDirections;
-        if (m_sprite.getPosition().x >= m_bounds.left + m_bounds.width)
+        // Construct the possible next directions (a fixed list, picking one doesn't allocate)
+        std::array<Moving, 4> allowedDirections{};
+        std::uint32_t         choices = 4;
+        if (m_position.x >= m_bounds.left + m_bounds.width)
         {
             // on right edge
             allowedDirections = {Moving::Up, Moving::Down, Moving::UpLeft, Moving::DownLeft};
         }
-        else if (m_sprite.getPosition().x < m_bounds.left)
+        else if (m_position.x < m_bounds.left)
         {
             // on left edge
             allowedDirections = {Moving::Up, Moving::Down, Moving::UpRight, Moving::DownRight};
@@ -111,20 +100,20 @@ void Spider::update(float deltaTime)
             allowedDirections = {Moving::Up, Moving::Down, Moving::UpRight, Moving::DownRight};
             if (m_canMoveLeft)
             {
-                allowedDirections.assign({Moving::UpLeft, Moving::DownLeft});
+                allowedDirections = {Moving::UpLeft, Moving::DownLeft};
+                choices           = 2;
             }
         }
 
-        std::uniform_int_distribution<size_t> dist(0, allowedDirections.size() - 1);
         // Pick from a random index in allowed directions
-        m_direction = allowedDirections[dist(m_rng)];
+        m_direction = allowedDirections[Game::randomBelow(m_rng, choices)];
 
         // reset timer and select new random duration
         m_moveTimer = 0;
     }
 
     // bounce off the edges predictably
-    if (m_sprite.getPosition().y < m_bounds.top)
+    if (m_position.y < m_bounds.top)
     {
         // On top edge
         switch (m_direction)
@@ -142,7 +131,7 @@ void Spider::update(float deltaTime)
             break;
         }
     }
-    else if (m_sprite.getPosition().y >= m_bounds.top + m_bounds.height)
+    else if (m_position.y >= m_bounds.top + m_bounds.height)
     {
         // On bottom edge
         switch (m_direction)
@@ -163,10 +152,10 @@ void Spider::update(float deltaTime)
 }
 
 /**  */
-bool Spider::checkLaserCollision(sf::FloatRect other)
+bool Spider::checkLaserCollision(FloatRect other)
 {
     // only living spiders can be hit
-    bool wasHit = m_alive && m_sprite.getGlobalBounds().intersects(other);
+    bool wasHit = m_alive && this->getCollider().intersects(other);
     if (wasHit)
     {
         m_alive = false;
@@ -174,7 +163,46 @@ bool Spider::checkLaserCollision(sf::FloatRect other)
     return wasHit;
 }
 
-sf::FloatRect Spider::getCollider() const
+const FloatRect& Spider::getCollider() const
+{
+    return m_collider;
+}
+
+void Spider::moveTo(Vec2f position)
+{
+    m_position = position;
+    m_collider = centeredRect(m_position, Spider::Size);
+}
+
+Vec2f Spider::getPosition() const
+{
+    return m_position;
+}
+
+bool Spider::isAlive() const
+{
+    return m_alive;
+}
+
+void Spider::save(ByteWriter& out) const
+{
+    out.vec(m_position);
+    out.byte(static_cast<std::uint8_t>(m_direction));
+    out.flag(m_alive);
+    out.f64(m_moveTimer);
+    out.f64(m_respawnTimer);
+    out.flag(m_canMoveLeft);
+    m_rng.save(out);
+}
+
+/** The timers are reset as soon as they reach their duration, so a saved timer is always below it */
+void Spider::restore(ByteReader& in)
 {
-    return m_sprite.getGlobalBounds();
+    this->moveTo(in.vecWithin({m_bounds.left - Spider::Reach, m_bounds.top - Spider::Reach, m_bounds.width + 2 * Spider::Reach, m_bounds.height + 2 * Spider::Reach}));
+    m_direction    = static_cast<Moving>(in.byteBelow(static_cast<std::uint8_t>(Moving::DownRight) + 1));
+    m_alive        = in.flag();
+    m_moveTimer    = in.f64Within(0, Spider::MoveDuration);
+    m_respawnTimer = in.f64Within(0, Spider::RespawnDuration);
+    m_canMoveLeft  = in.flag();
+    m_rng.restore(in);
 }
@@ -8,15 +8,22 @@ If the player hits the spider, a life is lost and the player is reset.
 */
 
 #pragma once
-#include <random>
+#include <cstdint>
 
-#include <SFML/Graphics.hpp>
+#include "Geometry.hpp"
+#include "Random.hpp"
+#include "Serialize.hpp"
 
-class Spider : public sf::Drawable
+class Spider
 {
   public:
-    /** Construct a new Spider object that moves within `bounds` */
-    Spider(sf::FloatRect bounds);
+    /** Size of the spider (px) */
+    static constexpr Vec2f Size{15, 8};
+
+    /** Construct a new Spider object that moves within `bounds`
+     * @param seed the same seed always gives the same movement
+     */
+    Spider(FloatRect bounds, std::uint32_t seed);
     // no default constructor
     Spider() = delete;
 
@@ -26,48 +33,59 @@ class Spider : public sf::Drawable
     /** Update the spider's movement based on elapsed time */
     void update(float deltaTime);
 
-    /** Draw only living spiders to the target
-     * Sprite overload
-     */
-    void draw(sf::RenderTarget& target, sf::RenderStates states) const;
-
     /** Check if a laser hit this spider, and 'kill' it
      * @return true if the spider was hit.
      */
-    bool checkLaserCollision(sf::FloatRect collider);
+    bool checkLaserCollision(FloatRect collider);
 
     /**
-     * Get the spider collider for collisions
+     * Get the spider collider for collisions (kept up to date as the spider moves)
      *
-     * @return sf::FloatRect
+     * @return FloatRect
      */
-    sf::FloatRect getCollider() const;
+    const FloatRect& getCollider() const;
+
+    /** @return the center of the spider */
+    Vec2f getPosition() const;
+
+    /** Only living spiders are drawn or collide */
+    bool isAlive() const;
+
+    /** Write position, movement timers and the random number engine to a snapshot */
+    void save(ByteWriter& out) const;
+
+    /** Read back the state written by save() */
+    void restore(ByteReader& in);
 
     /** States for the movement state-machine */
     enum class Moving { Up, Down, UpRight, UpLeft, DownLeft, DownRight };
 
   private:
-    /** The location of the spider texture in the sprite-sheet */
-    static inline const sf::IntRect SpiderTexOffset{8, 75, 15, 8};
     /** Speed of movement in px/s for both x and y components */
     static constexpr float Speed = 60;
     /**Move for 1 second before changing directions on average */
     static constexpr float AverageMoveDuration = 0.5;
-
     /** Seconds between changing direction */
-    const double m_moveDuration = 0.5;
-
+    static constexpr double MoveDuration = 0.5;
     /** Seconds to wait before re-spawning */
-    const double m_respawnDuration = 5;
+    static constexpr double RespawnDuration = 5;
+    /** Furthest the spider gets past its bounds: it only turns back when it next picks a direction */
+    static constexpr float Reach = Speed * static_cast<float>(MoveDuration);
+
+    /** Set the position, and the collider around it */
+    void moveTo(Vec2f position);
+
+    /** Center of the spider */
+    Vec2f m_position;
 
-    /** The spider sprite */
-    sf::Sprite m_sprite;
+    /** Bounding box around m_position */
+    FloatRect m_collider;
 
     /** The area the spider can move in */
-    sf::FloatRect m_bounds;
+    FloatRect m_bounds;
 
     /** Random number generator for erratic movement */
-    std::mt19937 m_rng;
+    Game::Rng m_rng;
 
     /** Current direction of movement */
     Moving m_direction;
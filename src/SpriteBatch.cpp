@@ -0,0 +1,70 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+SpriteBatch definition.
+*/
+
+#include <cstddef>
+
+#include <SFML/Graphics.hpp>
+
+#include "SpriteBatch.hpp"
+
+void SpriteBatch::setQuad(sf::Vertex* quad, const sf::FloatRect& position, const sf::FloatRect& texture, sf::Color color)
+{
+    const float x0 = position.left;
+    const float y0 = position.top;
+    const float x1 = position.left + position.width;
+    const float y1 = position.top + position.height;
+    const float u0 = texture.left;
+    const float v0 = texture.top;
+    const float u1 = texture.left + texture.width;
+    const float v1 = texture.top + texture.height;
+
+    quad[0] = sf::Vertex({x0, y0}, color, {u0, v0});
+    quad[1] = sf::Vertex({x1, y0}, color, {u1, v0});
+    quad[2] = sf::Vertex({x1, y1}, color, {u1, v1});
+    quad[3] = sf::Vertex({x0, y0}, color, {u0, v0});
+    quad[4] = sf::Vertex({x1, y1}, color, {u1, v1});
+    quad[5] = sf::Vertex({x0, y1}, color, {u0, v1});
+}
+
+/** resize() keeps the storage of a cleared array, so a steady frame does not allocate */
+void SpriteBatch::appendQuad(sf::VertexArray& vertices, const sf::FloatRect& position, const sf::FloatRect& texture, sf::Color color)
+{
+    const std::size_t first = vertices.getVertexCount();
+    vertices.resize(first + SpriteBatch::QuadVertices);
+    SpriteBatch::setQuad(&vertices[first], position, texture, color);
+}
+
+/** A change of texture or target can't share a draw call, so the queued quads go first */
+void SpriteBatch::add(sf::RenderTarget& target, const sf::Texture& texture, Vec2f center, Vec2f size, const sf::IntRect& texRect, bool flipped,
+                      sf::Color color)
+{
+    if (m_texture != &texture || m_target != &target)
+    {
+        this->flush();
+        m_texture = &texture;
+        m_target  = &target;
+    }
+
+    // mirroring the texture in both directions rotates it by 180 degrees
+    sf::FloatRect area{texRect};
+    if (flipped)
+    {
+        area = {area.left + area.width, area.top + area.height, -area.width, -area.height};
+    }
+    SpriteBatch::appendQuad(m_vertices, {center.x - size.x / 2.f, center.y - size.y / 2.f, size.x, size.y}, area, color);
+}
+
+/** clear() keeps the vertex storage, so the next batch reuses it */
+void SpriteBatch::flush()
+{
+    if (m_target != nullptr && m_vertices.getVertexCount() > 0)
+    {
+        m_target->draw(m_vertices, m_texture);
+    }
+    m_vertices.clear();
+}
@@ -0,0 +1,66 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Declare the SpriteBatch, which collects textured quads and draws them together.
+*/
+
+#pragma once
+#include <cstddef>
+
+#include <SFML/Graphics.hpp>
+
+#include "Geometry.hpp"
+
+/**
+ * Collects textured quads in draw order, and sends them to the target in as few draw calls as possible.
+ *
+ * Quads are queued until the texture or target changes, or flush() is called.
+ * Everything on the same sprite-sheet ends up in one draw call.
+ * The vertex storage is kept between frames, so a steady frame does not allocate.
+ */
+class SpriteBatch
+{
+  public:
+    /** Vertices of a quad (two triangles) */
+    static constexpr std::size_t QuadVertices = 6;
+
+    /**
+     * Write the two triangles of an axis-aligned quad, the only place quads are built
+     * @param quad the QuadVertices vertices to overwrite
+     * @param position area covered (world coordinates)
+     * @param texture area of the texture to show (negative sizes mirror it)
+     * @param color multiplies the texture color
+     */
+    static void setQuad(sf::Vertex* quad, const sf::FloatRect& position, const sf::FloatRect& texture, sf::Color color);
+
+    /** Append a quad to `vertices`, see setQuad() */
+    static void appendQuad(sf::VertexArray& vertices, const sf::FloatRect& position, const sf::FloatRect& texture, sf::Color color);
+
+    /**
+     * Queue a quad
+     * @param target where the quad will be drawn
+     * @param texture texture to sample
+     * @param center center of the quad (world coordinates)
+     * @param size size of the quad (px)
+     * @param texRect area of the texture to show
+     * @param flipped rotate the quad 180 degrees
+     * @param color multiplies the texture color
+     */
+    void add(sf::RenderTarget& target, const sf::Texture& texture, Vec2f center, Vec2f size, const sf::IntRect& texRect, bool flipped = false,
+             sf::Color color = sf::Color::White);
+
+    /** Draw every queued quad (one draw call), and start a new batch */
+    void flush();
+
+  private:
+    /** Queued quads */
+    sf::VertexArray m_vertices{sf::Triangles};
+
+    /** Target of the queued quads */
+    sf::RenderTarget* m_target = nullptr;
+
+    /** Texture of the queued quads */
+    const sf::Texture* m_texture = nullptr;
+};
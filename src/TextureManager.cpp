@@ -5,6 +5,8 @@ Copyright (c) 2024 Jackson Miller
 
 #include <cassert>
 #include <exception>
+#include <stdexcept>
+#include <string>
 
 #include "SFML/Graphics.hpp"
 
@@ -13,45 +15,35 @@ Copyright (c) 2024 Jackson Miller
 TextureManager* TextureManager::m_s_Instance = nullptr;
 
 /** Constructor sets up the static reference. */
-TextureManager::TextureManager() : m_texCache()
+TextureManager::TextureManager() : m_textures()
 {
     // assert prevent's multiple TextureManagers for being created
     assert(m_s_Instance == nullptr);
     m_s_Instance = this;
 }
 
+/** The pixels are already decoded, they go straight to the GPU */
+void TextureManager::finishLoading()
+{
+    for (std::size_t i = 0; i < TextureCount; i++)
+    {
+        const EmbeddedImage& image = *TextureManager::Images[i];
+        if (!m_textures[i].create(image.width, image.height))
+        {
+            throw std::runtime_error("Could not create texture " + std::to_string(i));
+        }
+        m_textures[i].update(image.pixels);
+    }
+}
+
 /**
- * @brief Return a texture reference, loading it from a file if necessary
+ * @brief Return a texture reference
  *
  * This is a static method that makes it easy for any code to get a texture reference.
- * @param path the texture to load
+ * @param id the texture to get
  * @return sf::Texture&
  */
-const sf::Texture& TextureManager::GetTexture(const char* path)
+const sf::Texture& TextureManager::GetTexture(TextureId id)
 {
-    // convert to string
-    std::string filename{path};
-    // reference to mapping in instance object
-    auto& texture_cache = m_s_Instance->m_texCache;
-
-    // Check mapping for the filename, return value if found (C++17 init statement syntax)
-    if (auto got = texture_cache.find(filename); got != texture_cache.end())
-    {
-
-        return got->second;
-    }
-    else
-    {
-        // File not loaded yet!
-        // Create a new key value pair using the filename
-        auto& texture = texture_cache[filename];
-
-        if (!texture.loadFromFile(filename))
-        {
-            // If file can't be found, abort
-            throw std::runtime_error("Could not load file: " + filename);
-        }
-        // texture is valid and loaded
-        return texture;
-    }
+    return m_s_Instance->m_textures[static_cast<std::size_t>(id)];
 }
@@ -4,29 +4,42 @@ Copyright (c) 2024 Jackson Miller
 */
 
 #pragma once
-
-#include <unordered_map>
+#include <array>
+#include <cstddef>
 
 #include "SFML/Graphics.hpp"
 
+#include "EmbeddedAssets.hpp"
+
+/** Every texture of the game, registered at compile time */
+enum class TextureId : std::size_t { Sprites, Splash, Count };
+
 /**
  * Central cache of textures.
- * Prevents loading files from disks more than once,
- * and allows many sprites to share the same texture.
+ * Every texture is loaded once at startup, and looked up by its TextureId,
+ * which allows many sprites to share the same texture.
+ *
+ * The images are decoded at build time and compiled into the executable
+ * (see tools/embed_assets.cpp), so loading is a straight upload with no file I/O,
+ * and the game runs from any working directory.
  * Modified from Chapter 18 code.
  */
 class TextureManager
 {
   private:
+    /** Number of textures */
+    static constexpr std::size_t TextureCount = static_cast<std::size_t>(TextureId::Count);
+
+    /** Pixels of each texture, indexed by TextureId */
+    static inline const std::array<const EmbeddedImage*, TextureCount> Images{&EmbeddedSprites, &EmbeddedSplash};
+
     /** Pointer of the same type as the class itself
      *  the one and only instance.
      * */
     static TextureManager* m_s_Instance;
 
-    /** Mapping of filenames to Texture objects */
-    std::unordered_map<std::string, sf::Texture> m_texCache;
-
-    // const sf::Image m_spriteSheet;
+    /** Every texture, indexed by TextureId (empty until finishLoading()) */
+    std::array<sf::Texture, TextureCount> m_textures;
 
   public:
     /**
@@ -36,11 +49,19 @@ class TextureManager
     TextureManager();
 
     /**
-     * @brief Return a texture reference, loading it from a file if necessary
+     * Upload every texture.
+     * Must be called before anything is drawn (needs an OpenGL context, which SFML makes if needed).
+     * @throws std::runtime_error if a texture can't be created
+     */
+    void finishLoading();
+
+    /**
+     * @brief Return a texture reference
      *
      * This is a static method that makes it easy for any code to get a texture reference.
-     * @param filename the texture to load
+     * The reference is valid from the start, the texture is filled in by finishLoading().
+     * @param id the texture to get
      * @return sf::Texture&
      */
-    static const sf::Texture& GetTexture(const char* path);
+    static const sf::Texture& GetTexture(TextureId id);
 };
@@ -0,0 +1,293 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Defines the game World and the rules for a single tick.
+*/
+
+#include <limits>
+#include <utility>
+
+#include "World.hpp"
+#include "Random.hpp"
+#include "Serialize.hpp"
+#include "Settings.hpp"
+
+namespace
+{
+
+/** Snapshot signature */
+constexpr char SnapshotMagic[4] = {'C', 'P', 'S', 'N'};
+
+} // namespace
+
+/**
+ * Construct a new World object.
+ * Initializer list handles creating and placing every game object.
+ * Each random object gets its own stream derived from the game seed.
+ */
+World::World(std::uint32_t seed)
+    : m_seed{seed},
+      m_player{Game::PlayerArea},
+      m_shroomMan{Game::ShroomArea, Game::streamSeed(seed, 1)},
+      m_centipede{Game::EnemyArea, m_shroomMan},
+      m_spider{Game::SpiderArea, Game::streamSeed(seed, 2)}
+{
+}
+
+/**
+ * Apply the player controls, then update all object positions and check for collisions.
+ * Every step is exactly Game::Tick seconds of game time.
+ */
+void World::step(const Input& input)
+{
+    m_player.setInput(input);
+    if (input.fire)
+    {
+        this->fire();
+    }
+
+    const float dtSeconds = Game::Tick;
+
+    {
+        CENTIPEDE_PROFILE(m_profiler, Phase::Spider);
+        m_shroomMan.checkSpiderCollision(m_spider.getCollider());
+
+        m_player.checkSpiderCollision(m_spider.getCollider());
+    }
+
+    {
+        CENTIPEDE_PROFILE(m_profiler, Phase::Lasers);
+        this->updateLasers(dtSeconds);
+    }
+
+    {
+        CENTIPEDE_PROFILE(m_profiler, Phase::Centipede);
+        m_centipede.update(dtSeconds);
+    }
+
+    {
+        CENTIPEDE_PROFILE(m_profiler, Phase::Movement);
+        m_spider.update(dtSeconds);
+        m_player.update(dtSeconds);
+    }
+
+    m_totalGameTime += dtSeconds;
+}
+
+/** Collide every active laser with the spider, mushrooms and centipede, then move it */
+void World::updateLasers(float dtSeconds)
+{
+    for (auto& laser : m_lasers)
+    {
+        // skip updating or colliding with inactive lasers
+        if (!laser.isActive())
+        {
+            continue;
+        }
+
+        const FloatRect& collider = laser.getCollider();
+        if (m_spider.checkLaserCollision(collider))
+        {
+            laser.deactivate();
+            continue;
+        }
+
+        if (m_shroomMan.checkLaserCollision(collider))
+        {
+            laser.deactivate();
+            continue;
+        }
+
+        if (m_centipede.checkLaserCollision(collider))
+        {
+            laser.deactivate();
+            continue;
+        }
+
+        laser.update(dtSeconds); // move the laser upward
+    }
+}
+
+/**
+ * Run a single game without rendering.
+ * The script is asked for the controls of every tick.
+ */
+std::uint64_t World::simulate(std::uint64_t maxTicks, const InputScript& script)
+{
+    std::uint64_t tick = 0;
+    while (tick < maxTicks && !this->isOver())
+    {
+        this->step(script(tick));
+        tick++;
+    }
+    return tick;
+}
+
+/** Recycle the next laser from the pool, limited by Laser::FireRate */
+void World::fire()
+{
+    const double elapsed = m_totalGameTime - m_lastFired;
+
+    // only fire after the firing period has elapsed
+    if (elapsed > 1 / Laser::FireRate)
+    {
+        m_lasers[m_currentLaser].shoot(m_player.getGunPosition());
+        m_currentLaser++;
+        if (m_currentLaser >= m_lasers.size())
+        {
+            m_currentLaser = 0;
+        }
+        m_lastFired = m_totalGameTime;
+    }
+}
+
+bool World::isOver() const
+{
+    return m_player.isDead();
+}
+
+std::uint32_t World::getSeed() const
+{
+    return m_seed;
+}
+
+/** Every object writes its own state, in the order they are stepped */
+std::vector<std::uint8_t> World::snapshot() const
+{
+    ByteWriter out;
+    out.raw(SnapshotMagic, sizeof(SnapshotMagic));
+    out.byte(World::SnapshotVersion);
+    out.le(m_seed, 4);
+    out.f64(m_totalGameTime);
+    out.f64(m_lastFired);
+    out.varint(m_currentLaser);
+
+    m_player.save(out);
+    for (const auto& laser : m_lasers)
+    {
+        laser.save(out);
+    }
+    m_shroomMan.save(out);
+    m_centipede.save(out);
+    m_spider.save(out);
+    return out.data();
+}
+
+void World::restore(const std::vector<std::uint8_t>& snapshot)
+{
+    this->restore(snapshot, "world snapshot");
+}
+
+void World::saveSnapshot(const std::string& path) const
+{
+    writeFile(path, this->snapshot(), "snapshot file: " + path);
+}
+
+void World::restoreSnapshot(const std::string& path)
+{
+    const std::string what = "snapshot file: " + path;
+    this->restore(readFile(path, what), what);
+}
+
+/**
+ * The snapshot is read into a fresh World, and only swapped in once all of it was valid,
+ * so a corrupt snapshot never leaves this World with parts that don't agree.
+ */
+void World::restore(const std::vector<std::uint8_t>& snapshot, const std::string& what)
+{
+    ByteReader in{snapshot, what};
+    World      restored{m_seed};
+    restored.read(in);
+    this->swap(restored);
+}
+
+void World::read(ByteReader& in)
+{
+    for (char c : SnapshotMagic)
+    {
+        if (in.byte() != static_cast<std::uint8_t>(c))
+        {
+            in.fail("Not a");
+        }
+    }
+    if (in.byte() != World::SnapshotVersion)
+    {
+        in.fail("Unsupported version of");
+    }
+
+    m_seed          = static_cast<std::uint32_t>(in.le(4));
+    // the first shot is at -1, before the game starts
+    m_totalGameTime = in.f64Within(0, std::numeric_limits<double>::max());
+    m_lastFired     = in.f64Within(-1, m_totalGameTime);
+    m_currentLaser  = static_cast<std::size_t>(in.varint());
+    if (m_currentLaser >= m_lasers.size())
+    {
+        in.fail("Invalid laser index in");
+    }
+
+    m_player.restore(in);
+    for (auto& laser : m_lasers)
+    {
+        laser.restore(in);
+    }
+    m_shroomMan.restore(in);
+    m_centipede.restore(in);
+    m_spider.restore(in);
+
+    if (!in.atEnd())
+    {
+        in.fail("Trailing data in");
+    }
+}
+
+void World::swap(World& other)
+{
+    std::swap(m_seed, other.m_seed);
+    std::swap(m_player, other.m_player);
+    m_shroomMan.swap(other.m_shroomMan);
+    m_centipede.swap(other.m_centipede);
+    std::swap(m_spider, other.m_spider);
+    std::swap(m_lasers, other.m_lasers);
+    std::swap(m_currentLaser, other.m_currentLaser);
+    std::swap(m_totalGameTime, other.m_totalGameTime);
+    std::swap(m_lastFired, other.m_lastFired);
+}
+
+void World::setMushroomListener(MushroomListener* listener)
+{
+    m_shroomMan.setListener(listener);
+}
+
+#ifdef CENTIPEDE_PROFILING
+void World::setProfiler(Profiler* profiler)
+{
+    m_profiler = profiler;
+}
+#endif
+
+const Player& World::getPlayer() const
+{
+    return m_player;
+}
+
+const MushroomManager& World::getMushrooms() const
+{
+    return m_shroomMan;
+}
+
+const Centipede& World::getCentipede() const
+{
+    return m_centipede;
+}
+
+const Spider& World::getSpider() const
+{
+    return m_spider;
+}
+
+const World::Lasers& World::getLasers() const
+{
+    return m_lasers;
+}
@@ -0,0 +1,184 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Declare the game World. It owns every game object and applies the game rules
+one fixed tick at a time. It has no dependency on SFML, so any number of worlds
+can be simulated in one process without a window.
+
+A World is fully deterministic: the same seed and the same Input for every tick
+always play out the same game (see Replay).
+
+The whole state of a World can be saved to a snapshot and restored later:
+
+    "CPSN"          magic (4 bytes)
+    version         u8
+    seed            u32
+    game time       f64, time of the last shot (f64), next laser in the pool (varint)
+    player          position, held controls, lives
+    lasers          active flag and position of every laser in the pool
+    mushrooms       count (varint), position and health of each, engine state
+    centipede       count (varint), position and movement state of each segment (a head starts each chain)
+    spider          position, direction, timers, engine state
+
+Integers are little endian, floats are stored as their exact bits, and an engine state
+is its 624 state words (u32 each) and the index of the next one (u16).
+*/
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Centipede.hpp"
+#include "Input.hpp"
+#include "Laser.hpp"
+#include "Mushrooms.hpp"
+#include "Player.hpp"
+#include "Profiler.hpp"
+#include "Spider.hpp"
+
+/**
+ * The World is responsible for:
+ *  - owning all the game objects,
+ *  - applying player controls,
+ *  - updating game objects,
+ *  - detecting collisions
+ */
+class World
+{
+  public:
+    /** A pool of 30 laser objects to recycle (should be plenty) */
+    using Lasers = std::array<Laser, 30>;
+
+    /**
+     * Construct a new World with the default game areas
+     * @param seed seeds every random number generator in the game
+     */
+    explicit World(std::uint32_t seed);
+
+    // No copy constructor (the centipede refers to the mushrooms)
+    World(const World&) = delete;
+
+    // No copy assignment
+    World& operator=(const World&) = delete;
+
+    /**
+     * Advance the game by one tick (Game::Tick seconds).
+     * @param input the player controls for this tick
+     */
+    void step(const Input& input);
+
+    /**
+     * Play one game as fast as the CPU allows.
+     *
+     * @param maxTicks stop after this many ticks, even if the player is still alive
+     * @param script input source, called once per tick
+     * @return the number of ticks simulated before the player died (or maxTicks)
+     */
+    std::uint64_t simulate(std::uint64_t maxTicks, const InputScript& script);
+
+    /** @return true once the player has used up all their lives */
+    bool isOver() const;
+
+    /** @return the seed this World was created with */
+    std::uint32_t getSeed() const;
+
+    /** Current version of the snapshot format */
+    static constexpr std::uint8_t SnapshotVersion = 4;
+
+    /** @return the complete game state as a snapshot */
+    std::vector<std::uint8_t> snapshot() const;
+
+    /**
+     * Replace the complete game state with a snapshot.
+     * Stepping afterwards plays out exactly as the original World did.
+     * @throws std::runtime_error if the snapshot is invalid (the World is left unchanged)
+     */
+    void restore(const std::vector<std::uint8_t>& snapshot);
+
+    /**
+     * Write a snapshot to a file
+     * @throws std::runtime_error if the file can't be written
+     */
+    void saveSnapshot(const std::string& path) const;
+
+    /**
+     * Restore a snapshot from a file
+     * @throws std::runtime_error if the file is missing or invalid
+     */
+    void restoreSnapshot(const std::string& path);
+
+    /** Send every mushroom change to `listener` (nullptr to stop), see MushroomManager::setListener */
+    void setMushroomListener(MushroomListener* listener);
+
+#ifdef CENTIPEDE_PROFILING
+    /** Time each phase of step() into `profiler` (nullptr to stop) */
+    void setProfiler(Profiler* profiler);
+#endif
+
+    /** @return the player-controlled starship */
+    const Player& getPlayer() const;
+
+    /** @return the manager of all mushrooms */
+    const MushroomManager& getMushrooms() const;
+
+    /** @return all the centipede segments */
+    const Centipede& getCentipede() const;
+
+    /** @return the spider antagonist */
+    const Spider& getSpider() const;
+
+    /** @return the whole laser pool (inactive ones included) */
+    const Lasers& getLasers() const;
+
+  private:
+    /** Shoot the next laser in the pool, if the firing period has elapsed */
+    void fire();
+
+    /** Collide and move every active laser */
+    void updateLasers(float dtSeconds);
+
+    /** Restore from a snapshot buffer, `what` names it in error messages */
+    void restore(const std::vector<std::uint8_t>& snapshot, const std::string& what);
+
+    /** Overwrite every member with a snapshot, throws part way through if it is invalid */
+    void read(ByteReader& in);
+
+    /** Exchange the game state with `other` (the listener and profiler stay with each World) */
+    void swap(World& other);
+
+    /** Seed for all random behavior */
+    std::uint32_t m_seed;
+
+    /** The player-controlled starship */
+    Player m_player;
+
+    /** Manager for all the mushrooms in the scene */
+    MushroomManager m_shroomMan;
+
+    /** All the centipedes on the screen */
+    Centipede m_centipede;
+
+    /** The spider antagonist moves randomly and clears mushrooms */
+    Spider m_spider;
+
+    /** Lasers are recycled, the next one to fire is m_currentLaser */
+    Lasers m_lasers;
+
+    std::size_t m_currentLaser = 0;
+
+    /** Elapsed game time (seconds) */
+    double m_totalGameTime = 0;
+
+    /** Time a laser was fired (seconds, negative so the first shot is immediate) */
+    double m_lastFired = -1;
+
+#ifdef CENTIPEDE_PROFILING
+    /** Receives the phase timings (not owned) */
+    Profiler* m_profiler = nullptr;
+#endif
+};
@@ -4,18 +4,247 @@ Copyright (c) 2024 Jackson Miller
 
 Description:
 Centipede Game using C++ and SFML.
+
+Usage:
+    centipede                         play the game in a window
+    centipede --headless [--ticks N]  simulate games without a window, as fast as possible
+              [--worlds N]            number of independent games (default 1)
+              [--threads N]           worker threads for --worlds (default all cores)
+    common options:
+              [--seed N]              seed of the (first) game, random by default
+              [--record FILE]         record the game to a replay file
+              [--replay FILE]         play back a replay file (real-time, or as fast as possible when headless)
+    window options:
+              [--latency]             report the latency from key presses to the displayed frame on exit
+              [--sim-rate HZ]         simulation ticks per second of real time (default 60, normal speed)
+              [--render-rate HZ]      draw at HZ frames per second, independent of ticks (0 for unlimited).
+                                      By default a frame is drawn after every tick.
+              [--max-catch-up N]      most ticks stepped in one frame when the game falls behind (default 5)
 */
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+
 #include "Engine.hpp"
+#include "FramePacer.hpp"
+#include "Input.hpp"
+#include "Replay.hpp"
+#include "Runner.hpp"
+#include "World.hpp"
+
+namespace
+{
+
+/** Default limit for headless games (one hour of game time) */
+constexpr std::uint64_t DefaultMaxTicks = 60 * 60 * 60;
+
+/** Command line options */
+struct Options
+{
+    bool                         headless = false;
+    std::uint64_t                maxTicks = DefaultMaxTicks;
+    std::size_t                  worlds   = 1;
+    unsigned                     threads  = 0;
+    std::optional<std::uint32_t> seed;
+    std::string                  recordPath;
+    std::string                  replayPath;
+    bool                         latency = false;
+    FramePacer::Settings         pacing;
+};
 
-int main()
+/**
+ * Built-in bot for headless games.
+ * Always firing, sweeping left and right every two seconds of game time.
+ */
+Input demoScript(std::uint64_t tick)
+{
+    Input input;
+    input.fire = true;
+    if ((tick / 120) % 2 == 0)
+    {
+        input.left = true;
+    }
+    else
+    {
+        input.right = true;
+    }
+    return input;
+}
+
+/** Print the final state of a single headless game, for comparing runs */
+void printGame(const World& world, std::uint64_t ticks)
+{
+    std::cout << "Seed " << world.getSeed() << ": " << ticks << " ticks, " << world.getPlayer().getLives() << " lives, "
+              << world.getMushrooms().getShrooms().size() << " mushrooms, " << world.getCentipede().getSegmentCount()
+              << " segments" << std::endl;
+}
+
+/** Play back a replay as fast as possible */
+int replayHeadless(const Options& options)
+{
+    const Replay replay = Replay::load(options.replayPath);
+
+    World world{replay.getSeed()};
+    const auto ticks = world.simulate(replay.getTicks(), [&](std::uint64_t tick) { return replay.at(tick); });
+    printGame(world, ticks);
+    return EXIT_SUCCESS;
+}
+
+/** Record a single game of the built-in bot */
+int recordHeadless(const Options& options)
+{
+    const std::uint32_t seed = options.seed ? *options.seed : std::random_device{}();
+
+    World  world{seed};
+    Replay replay{seed};
+    const auto ticks = world.simulate(options.maxTicks, [&](std::uint64_t tick) {
+        const Input input = demoScript(tick);
+        replay.record(input);
+        return input;
+    });
+    replay.save(options.recordPath);
+    printGame(world, ticks);
+    return EXIT_SUCCESS;
+}
+
+/** Run headless games and report the simulation speed.
+ *  Only Worlds are created, so there is no window, texture or OpenGL context.
+ */
+int runHeadless(const Options& options)
+{
+    if (!options.replayPath.empty())
+    {
+        return replayHeadless(options);
+    }
+    if (!options.recordPath.empty())
+    {
+        if (options.worlds != 1)
+        {
+            std::cerr << "--record only works with a single world" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return recordHeadless(options);
+    }
+
+    Runner              runner{options.threads};
+    const std::uint32_t firstSeed = options.seed ? *options.seed : std::random_device{}();
+
+    const auto   start   = std::chrono::steady_clock::now();
+    const auto   results = runner.run(options.worlds, options.maxTicks, demoScript, firstSeed);
+    const auto   end     = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::uint64_t ticks   = 0;
+    std::uint64_t longest = 0;
+    for (const auto& result : results)
+    {
+        ticks += result.ticks;
+        longest = std::max(longest, result.ticks);
+    }
+
+    std::cout << "Simulated " << options.worlds << " games from seed " << firstSeed << " (" << ticks << " ticks, longest "
+              << longest << ") on " << runner.getThreads() << " threads in " << seconds << "s ("
+              << static_cast<double>(ticks) / seconds << " ticks/s)" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
 {
     try
     {
+        Options options;
+
+        for (int i = 1; i < argc; i++)
+        {
+            const bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--headless") == 0)
+            {
+                options.headless = true;
+            }
+            else if (std::strcmp(argv[i], "--ticks") == 0 && hasValue)
+            {
+                options.maxTicks = std::stoull(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--worlds") == 0 && hasValue)
+            {
+                options.worlds = std::stoull(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            {
+                options.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+            }
+            else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+            {
+                options.seed = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (std::strcmp(argv[i], "--record") == 0 && hasValue)
+            {
+                options.recordPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--replay") == 0 && hasValue)
+            {
+                options.replayPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--latency") == 0)
+            {
+                options.latency = true;
+            }
+            else if (std::strcmp(argv[i], "--sim-rate") == 0 && hasValue)
+            {
+                options.pacing.simRate = std::stod(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--render-rate") == 0 && hasValue)
+            {
+                options.pacing.sync       = FramePacer::Sync::Independent;
+                options.pacing.renderRate = std::stod(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--max-catch-up") == 0 && hasValue)
+            {
+                options.pacing.maxCatchUp = static_cast<unsigned>(std::stoul(argv[++i]));
+            }
+            else
+            {
+                std::cerr << "Unknown argument: " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (options.headless)
+        {
+            return runHeadless(options);
+        }
+
         Engine engine;
+        engine.setPacing(options.pacing);
+        if (options.seed)
+        {
+            engine.setSeed(*options.seed);
+        }
+        if (!options.recordPath.empty())
+        {
+            engine.recordTo(options.recordPath);
+        }
+        if (!options.replayPath.empty())
+        {
+            engine.replay(Replay::load(options.replayPath));
+        }
+        if (options.latency)
+        {
+            engine.measureLatency();
+        }
         engine.run();
     }
     catch (const std::exception& e)
     {
+        std::cerr << e.what() << std::endl;
         return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
@@ -0,0 +1,43 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+A minimal check helper for the CTest programs in tests/.
+Every failed check is printed, and the program exits non-zero if any failed.
+*/
+
+#pragma once
+#include <iostream>
+#include <string>
+
+/** Counts the failed checks of one test program */
+class Checks
+{
+  public:
+    /**
+     * Record one check
+     * @param ok result of the check
+     * @param what printed if the check failed
+     */
+    void check(bool ok, const std::string& what)
+    {
+        m_total++;
+        if (!ok)
+        {
+            m_failed++;
+            std::cerr << "FAILED: " << what << "\n";
+        }
+    }
+
+    /** Print a summary, @return the exit code of the program */
+    int finish() const
+    {
+        std::cout << (m_total - m_failed) << "/" << m_total << " checks passed\n";
+        return m_failed == 0 ? 0 : 1;
+    }
+
+  private:
+    int m_total  = 0;
+    int m_failed = 0;
+};
@@ -0,0 +1,108 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Every Collision kernel this CPU runs must return the same hit masks as testing the
+boxes one at a time with FloatRect::intersects, for any number of boxes (the SIMD
+kernels finish the last boxes of a count that isn't a multiple of their width one by one).
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Check.hpp"
+#include "Collision.hpp"
+#include "Random.hpp"
+
+namespace
+{
+
+/** Units per pixel of the boxes (same as the centipede) */
+constexpr std::int32_t Scale = 16;
+
+/** Box size (units) */
+constexpr std::int32_t BoxSize = 8 * Scale;
+
+/** @return hit mask of testing the boxes one at a time against `rect` */
+std::vector<std::uint64_t> bruteForce(const FloatRect& rect, const std::vector<std::int32_t>& x, const std::vector<std::int32_t>& y)
+{
+    std::vector<std::uint64_t> masks(Collision::maskWords(x.size()), 0);
+    for (std::size_t i = 0; i < x.size(); i++)
+    {
+        const FloatRect box{static_cast<float>(x[i] - BoxSize / 2) / Scale, static_cast<float>(y[i] - BoxSize / 2) / Scale, static_cast<float>(BoxSize) / Scale,
+                            static_cast<float>(BoxSize) / Scale};
+        if (rect.intersects(box))
+        {
+            masks[i / Collision::MaskBits] |= std::uint64_t{1} << (i % Collision::MaskBits);
+        }
+    }
+    return masks;
+}
+
+} // namespace
+
+int main()
+{
+    Checks checks;
+    Game::Rng rng{1234};
+
+    const Collision::Kernel kernels[] = {Collision::Kernel::Scalar, Collision::Kernel::Sse2, Collision::Kernel::Avx2};
+    const char*             names[]   = {"scalar", "sse2", "avx2"};
+
+    // every tail length of both SIMD widths, and counts spanning several mask words
+    std::vector<std::size_t> counts;
+    for (std::size_t count = 0; count <= 17; count++)
+    {
+        counts.push_back(count);
+    }
+    counts.insert(counts.end(), {63, 64, 65, 130});
+
+    for (std::size_t count : counts)
+    {
+        for (int round = 0; round < 50; round++)
+        {
+            // boxes packed in a small area, so roughly half of them are hit (some only touch)
+            std::vector<std::int32_t> x(count);
+            std::vector<std::int32_t> y(count);
+            for (std::size_t i = 0; i < count; i++)
+            {
+                x[i] = static_cast<std::int32_t>(Game::randomBelow(rng, 64 * Scale));
+                y[i] = static_cast<std::int32_t>(Game::randomBelow(rng, 64 * Scale));
+            }
+            // rectangles in fractions of a pixel, to exercise the rounding of toEdges
+            const FloatRect rect{static_cast<float>(Game::randomBelow(rng, 48 * 8)) / 8.f, static_cast<float>(Game::randomBelow(rng, 48 * 8)) / 8.f,
+                                 static_cast<float>(1 + Game::randomBelow(rng, 16 * 8)) / 8.f, static_cast<float>(1 + Game::randomBelow(rng, 16 * 8)) / 8.f};
+
+            const std::vector<std::uint64_t> expected = bruteForce(rect, x, y);
+            const Collision::CenteredBoxes   boxes{x.data(), y.data(), count, BoxSize, BoxSize};
+            const Collision::Edges           edges = Collision::toEdges(rect, Scale);
+
+            for (std::size_t k = 0; k < std::size(kernels); k++)
+            {
+                if (!Collision::hasKernel(kernels[k]))
+                {
+                    continue;
+                }
+                // stale bits must be cleared by the kernel
+                std::vector<std::uint64_t> masks(expected.size(), ~std::uint64_t{0});
+                Collision::intersect(kernels[k], edges, boxes, masks.data());
+                checks.check(masks == expected, std::string(names[k]) + " kernel, " + std::to_string(count) + " boxes, round " + std::to_string(round));
+            }
+
+            std::vector<std::uint64_t> masks(expected.size(), 0);
+            Collision::intersect(edges, boxes, masks.data());
+            checks.check(masks == expected, std::string("picked kernel (") + Collision::kernelName() + "), " + std::to_string(count) + " boxes");
+        }
+    }
+
+    for (std::size_t k = 0; k < std::size(kernels); k++)
+    {
+        std::cout << names[k] << (Collision::hasKernel(kernels[k]) ? " tested\n" : " not supported, skipped\n");
+    }
+    return checks.finish();
+}
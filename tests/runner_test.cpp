@@ -0,0 +1,78 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+The Runner plays the same games whatever the thread count, and an exception thrown
+inside a game reaches the caller of run() instead of terminating the process.
+*/
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Check.hpp"
+#include "Runner.hpp"
+
+namespace
+{
+
+Input script(std::uint64_t tick)
+{
+    Input input;
+    input.fire  = tick % 3 == 0;
+    input.left  = (tick / 120) % 2 == 1;
+    input.right = !input.left;
+    return input;
+}
+
+bool sameResults(const std::vector<GameResult>& a, const std::vector<GameResult>& b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i].seed != b[i].seed || a[i].ticks != b[i].ticks || a[i].playerDied != b[i].playerDied || a[i].livesLeft != b[i].livesLeft ||
+            a[i].mushrooms != b[i].mushrooms || a[i].segments != b[i].segments)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    Checks checks;
+
+    const std::vector<GameResult> single = Runner{1}.run(24, 2000, script, 1);
+    const std::vector<GameResult> pooled = Runner{4}.run(24, 2000, script, 1);
+    checks.check(single.size() == 24, "one result per game");
+    checks.check(sameResults(single, pooled), "4 threads play the same games as 1");
+
+    // every game throws partway through, from several threads at once
+    const InputScript throwing = [](std::uint64_t tick) {
+        if (tick == 500)
+        {
+            throw std::runtime_error("script failed");
+        }
+        return script(tick);
+    };
+    bool caught = false;
+    try
+    {
+        Runner{4}.run(24, 2000, throwing, 1);
+    }
+    catch (const std::runtime_error& error)
+    {
+        caught = std::string(error.what()) == "script failed";
+    }
+    checks.check(caught, "an exception in a game is rethrown by run()");
+
+    return checks.finish();
+}
@@ -0,0 +1,283 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Round trips of the snapshot and replay formats:
+ - a restored snapshot saves back to the same bytes, and plays on exactly like the original,
+ - a replay saved to disk and loaded back replays the recorded game to the same final state,
+ - mushrooms outside the grid of the restoring manager are restored (the grid grows to fit them),
+ - corrupt engine states, out-of-range or non-finite positions and timers, and corrupt replay files are rejected.
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Check.hpp"
+#include "Laser.hpp"
+#include "Mushrooms.hpp"
+#include "Player.hpp"
+#include "Random.hpp"
+#include "Replay.hpp"
+#include "Serialize.hpp"
+#include "Settings.hpp"
+#include "Spider.hpp"
+#include "World.hpp"
+
+namespace
+{
+
+/** Random controls that keep the player moving and shooting, so the game has splits and spider kills */
+Input randomInput(Game::Rng& rng)
+{
+    const std::uint32_t bits = Game::randomBelow(rng, 32);
+    Input               input;
+    input.up    = (bits & 1u) != 0;
+    input.down  = (bits & 2u) != 0;
+    input.left  = (bits & 4u) != 0;
+    input.right = (bits & 8u) != 0;
+    input.fire  = (bits & 16u) != 0 || Game::randomBelow(rng, 2) == 0;
+    return input;
+}
+
+/** Play `ticks` ticks of `world` (or until the game is over), recording the controls into `replay` */
+void play(World& world, Replay& replay, Game::Rng& rng, std::uint64_t ticks)
+{
+    for (std::uint64_t t = 0; t < ticks && !world.isOver(); t++)
+    {
+        const Input input = randomInput(rng);
+        replay.record(input);
+        world.step(input);
+    }
+}
+
+void checkSnapshots(Checks& checks, std::uint32_t seed)
+{
+    const std::string name = "seed " + std::to_string(seed);
+    Game::Rng         rng{seed};
+    World             original{seed};
+    Replay            replay{seed};
+    play(original, replay, rng, 600);
+
+    const std::vector<std::uint8_t> saved = original.snapshot();
+    World                           restored{seed + 1000};
+    restored.restore(saved);
+    checks.check(restored.snapshot() == saved, name + ": save -> restore -> save gives the same bytes");
+
+    // a snapshot that only fails in its last section must leave the World untouched
+    std::vector<std::uint8_t> truncated = saved;
+    truncated.pop_back();
+    World                           untouched{seed + 2000};
+    const std::vector<std::uint8_t> before = untouched.snapshot();
+    bool                            threw  = false;
+    try
+    {
+        untouched.restore(truncated);
+    }
+    catch (const std::runtime_error&)
+    {
+        threw = true;
+    }
+    checks.check(threw && untouched.snapshot() == before, name + ": a failed restore leaves the World unchanged");
+
+    // both Worlds must play out the same from here on
+    Game::Rng inputs{seed + 1};
+    for (std::uint64_t t = 0; t < 1200 && !original.isOver(); t++)
+    {
+        const Input input = randomInput(inputs);
+        original.step(input);
+        restored.step(input);
+    }
+    checks.check(restored.snapshot() == original.snapshot(), name + ": a restored World plays on like the original");
+}
+
+void checkReplay(Checks& checks, std::uint32_t seed)
+{
+    const std::string name = "seed " + std::to_string(seed);
+    Game::Rng         rng{seed};
+    World             recorded{seed};
+    Replay            replay{seed};
+    play(recorded, replay, rng, 3000);
+
+    const std::string path = "centipede_test_" + std::to_string(seed) + ".rpl";
+    replay.save(path);
+    const Replay loaded = Replay::load(path);
+    std::remove(path.c_str());
+    checks.check(loaded.getSeed() == seed && loaded.getTicks() == replay.getTicks(), name + ": replay file keeps the seed and tick count");
+
+    World replayed{loaded.getSeed()};
+    for (std::uint64_t t = 0; t < loaded.getTicks(); t++)
+    {
+        replayed.step(loaded.at(t));
+    }
+    checks.check(replayed.snapshot() == recorded.snapshot(), name + ": replaying the file reaches the recorded final state");
+}
+
+/** Growing the grid during a restore moves the mushroom array, which once left a dangling reference */
+void checkRestoreOutsideGrid(Checks& checks)
+{
+    // the far mushroom is saved first, and lands well outside the grid of the restoring manager
+    MushroomManager saved{{0, 0, 240, 256}, 1, 0};
+    saved.addMushroom({2004, 1604});
+    saved.addMushroom({20, 20});
+    ByteWriter out;
+    saved.save(out);
+
+    MushroomManager restored{{0, 0, 64, 64}, 2, 0};
+    ByteReader      in{out.data(), "mushroom snapshot"};
+    restored.restore(in);
+    checks.check(restored.getShrooms().size() == 2, "mushrooms outside the grid: both restored");
+    checks.check(restored.hasShroom(250, 200) && restored.hasShroom(2, 2), "mushrooms outside the grid: both cells occupied");
+
+    ByteWriter again;
+    restored.save(again);
+    checks.check(again.data() == out.data(), "mushrooms outside the grid: save -> restore -> save gives the same bytes");
+}
+
+/** @return true if restoring `data` into a fresh `T` throws std::runtime_error */
+template <typename T, typename Make> bool rejects(const std::vector<std::uint8_t>& data, Make make)
+{
+    T          target = make();
+    ByteReader in{data, "corrupt data"};
+    try
+    {
+        target.restore(in);
+    }
+    catch (const std::runtime_error&)
+    {
+        return true;
+    }
+    return false;
+}
+
+void checkCorruptData(Checks& checks)
+{
+    // the engine state is 624 words then a u16 index, which can't be past the last word
+    Game::Rng rng{7};
+    rng();
+    ByteWriter engine;
+    rng.save(engine);
+    std::vector<std::uint8_t> data = engine.data();
+    data[data.size() - 2]          = 0x71; // 625
+    data[data.size() - 1]          = 0x02;
+    checks.check(rejects<Game::Rng>(data, [] { return Game::Rng{}; }), "engine index past the state is rejected");
+
+    Game::Rng  copy;
+    ByteReader in{engine.data(), "engine state"};
+    copy.restore(in);
+    checks.check(copy() == rng(), "engine state round trips");
+
+    // NaN fails every range comparison
+    ByteWriter shroom;
+    shroom.vec({std::numeric_limits<float>::quiet_NaN(), 4});
+    shroom.byte(1);
+    checks.check(rejects<Shroom>(shroom.data(), [] { return Shroom{0, 0}; }), "NaN mushroom position is rejected");
+
+    const auto makePlayer = [] { return Player{Game::PlayerArea}; };
+    const auto makeSpider = [] { return Spider{Game::SpiderArea, 1}; };
+    ByteWriter player;
+    player.vec({std::numeric_limits<float>::infinity(), 230});
+    checks.check(rejects<Player>(player.data(), makePlayer), "infinite player position is rejected");
+    ByteWriter above;
+    above.vec({100, 0});
+    checks.check(rejects<Player>(above.data(), makePlayer), "player position above the player area is rejected");
+
+    ByteWriter laser;
+    laser.flag(true);
+    laser.vec({100, -100});
+    checks.check(rejects<Laser>(laser.data(), [] { return Laser{}; }), "laser position far above the field is rejected");
+
+    // a valid position, direction and alive flag, then a NaN move timer
+    ByteWriter spider;
+    spider.vec({100, 180});
+    spider.byte(0);
+    spider.flag(true);
+    spider.f64(std::numeric_limits<double>::quiet_NaN());
+    checks.check(rejects<Spider>(spider.data(), makeSpider), "NaN spider timer is rejected");
+}
+
+/** @return true if Replay::load rejects a file holding `data` with std::runtime_error */
+bool replayRejected(const std::vector<std::uint8_t>& data)
+{
+    const std::string path = "centipede_test_corrupt.rpl";
+    writeFile(path, data, "test replay");
+    bool rejected = false;
+    try
+    {
+        Replay::load(path);
+    }
+    catch (const std::runtime_error&)
+    {
+        rejected = true;
+    }
+    std::remove(path.c_str());
+    return rejected;
+}
+
+/** Header of a replay file claiming `ticks` ticks */
+ByteWriter replayHeader(std::uint64_t ticks)
+{
+    ByteWriter out;
+    out.raw("CPRP", 4);
+    out.byte(Replay::Version);
+    out.le(1, 4);
+    out.le(ticks, 8);
+    return out;
+}
+
+void checkCorruptReplays(Checks& checks)
+{
+    ByteWriter valid = replayHeader(5);
+    valid.byte(0x11); // fire + up
+    valid.varint(3);
+    valid.byte(0x04); // left
+    valid.varint(2);
+    checks.check(!replayRejected(valid.data()), "a valid hand-written replay loads");
+
+    std::vector<std::uint8_t> truncated = valid.data();
+    truncated.pop_back();
+    checks.check(replayRejected(truncated), "truncated replay is rejected");
+
+    std::vector<std::uint8_t> trailing = valid.data();
+    trailing.push_back(0);
+    checks.check(replayRejected(trailing), "replay with trailing bytes is rejected");
+
+    ByteWriter unknown = replayHeader(1);
+    unknown.byte(0x20);
+    unknown.varint(1);
+    checks.check(replayRejected(unknown.data()), "replay with unknown control bits is rejected");
+
+    // one run claiming 2^40 ticks fits in a 20 byte file
+    ByteWriter huge = replayHeader(std::uint64_t{1} << 40);
+    huge.byte(0);
+    huge.varint(std::uint64_t{1} << 40);
+    checks.check(replayRejected(huge.data()), "replay with an oversized tick count is rejected without allocating it");
+}
+
+} // namespace
+
+int main()
+{
+    Checks checks;
+    try
+    {
+        for (std::uint32_t seed = 1; seed <= 20; seed++)
+        {
+            checkSnapshots(checks, seed);
+            checkReplay(checks, seed);
+        }
+        checkRestoreOutsideGrid(checks);
+        checkCorruptData(checks);
+        checkCorruptReplays(checks);
+    }
+    catch (const std::exception& error)
+    {
+        checks.check(false, error.what());
+    }
+    return checks.finish();
+}
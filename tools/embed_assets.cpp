@@ -0,0 +1,91 @@
+/*
+SPDX-License-Identifier: BSD-3-Clause
+Copyright (c) 2024 Jackson Miller
+
+Description:
+Build step that decodes images and writes them as RGBA arrays in a C++ source file,
+so the game starts without reading or decoding any file.
+
+usage: centipede_embed OUTPUT.cpp Name=image.png...
+Each image becomes `const EmbeddedImage EmbeddedName` (see src/EmbeddedAssets.hpp).
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <SFML/Graphics.hpp>
+
+namespace
+{
+
+/** Bytes per line of the generated arrays */
+constexpr std::size_t BytesPerLine = 24;
+
+/** Write one image as a pixel array and its EmbeddedImage */
+bool embed(std::ostream& out, const std::string& name, const std::string& path)
+{
+    sf::Image image;
+    if (!image.loadFromFile(path))
+    {
+        std::cerr << "Could not load file: " << path << std::endl;
+        return false;
+    }
+
+    const sf::Vector2u  size   = image.getSize();
+    const std::uint8_t* pixels = image.getPixelsPtr();
+    const std::size_t   count  = static_cast<std::size_t>(size.x) * size.y * 4;
+
+    out << "\n// " << path << "\n";
+    out << "namespace\n{\nconst std::uint8_t " << name << "Pixels[] = {";
+    for (std::size_t i = 0; i < count; i++)
+    {
+        out << (i % BytesPerLine == 0 ? "\n    " : " ") << static_cast<unsigned>(pixels[i]) << ",";
+    }
+    out << "\n};\n} // namespace\n\n";
+    out << "const EmbeddedImage Embedded" << name << "{" << size.x << ", " << size.y << ", " << name << "Pixels};\n";
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: centipede_embed OUTPUT.cpp Name=image.png..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // written to a string first, so a failure never leaves a half-written source behind
+    std::ostringstream source;
+    source << "// Generated by tools/embed_assets.cpp, do not edit\n\n";
+    source << "#include <cstdint>\n\n#include \"EmbeddedAssets.hpp\"\n";
+    for (int i = 2; i < argc; i++)
+    {
+        const std::string arg{argv[i]};
+        const auto        equals = arg.find('=');
+        if (equals == std::string::npos || equals == 0)
+        {
+            std::cerr << "Expected Name=image.png, got: " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (!embed(source, arg.substr(0, equals), arg.substr(equals + 1)))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ofstream out{argv[1], std::ios::binary};
+    out << source.str();
+    if (!out)
+    {
+        std::cerr << "Could not write file: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}